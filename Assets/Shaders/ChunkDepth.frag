@@ -2,10 +2,13 @@
 
 uniform sampler2D u_TextureAtlas;
 
-in vec2 v_TexCoords;
+in vec2 v_FaceCoords;
+flat in uint v_TextureIndex;
 
 void main()
 {
-	float a = texture(u_TextureAtlas, v_TexCoords).a;
+	vec2 tile = vec2(v_TextureIndex & 0xFu, 15u - (v_TextureIndex >> 4u));
+	vec2 texCoords = (tile + fract(v_FaceCoords)) / 16.0;
+	float a = texture(u_TextureAtlas, texCoords).a;
 	if (a < 0.05) discard;
 }
\ No newline at end of file
@@ -7,13 +7,17 @@ layout (std140) uniform Matrices
 	mat4 u_Projection;
 	mat4 u_View;
 	mat4 u_LightSpace[4];
-	mat4 u_NormalTransform;
 };
 
 uniform uint u_CascadeIndex;
 uniform ivec3 u_Position = ivec3(0);
+// Width of the chunk's blocks, above one for LOD chunks
+uniform int u_Scale = 1;
 
-out vec2 v_TexCoords;
+// In blocks across the face, the texture repeats once per block, as faces
+// merged for the shadow mesh can span many
+out vec2 v_FaceCoords;
+flat out uint v_TextureIndex;
 
 void main()
 {
@@ -24,16 +28,19 @@ void main()
 		(a_Data >> 12u) & 0x3Fu
 	);
 
-	uint textureIndex = (a_Data >> 18u) & 0xFFu;
-	float u = (a_Data >> 26u) & 0x1u;
-	float v = (a_Data >> 27u) & 0x1u;
+	v_TextureIndex = (a_Data >> 18u) & 0xFFu;
+	uint face = (a_Data >> 28u) & 0x7u;
 
-	v_TexCoords = vec2(
-		((textureIndex & 0xFu) + u) / 16.0,
-		(15u - (textureIndex >> 4u) + v) / 16.0
-	);
+	// Lines up with the texture coordinates of a single block's face
+	vec3 p = vec3(chunkOffset);
+	if (face == 0u) v_FaceCoords = vec2(p.x, p.y);
+	else if (face == 1u) v_FaceCoords = vec2(-p.x, p.y);
+	else if (face == 2u) v_FaceCoords = vec2(p.z, p.y);
+	else if (face == 3u) v_FaceCoords = vec2(-p.z, p.y);
+	else if (face == 4u) v_FaceCoords = vec2(p.x, -p.z);
+	else v_FaceCoords = vec2(p.x, p.z);
 
-	vec4 worldPosition = vec4(u_Position + chunkOffset, 1.0);
+	vec4 worldPosition = vec4(u_Position + chunkOffset * u_Scale, 1.0);
 
 	gl_Position = u_LightSpace[u_CascadeIndex] * worldPosition;
 }
\ No newline at end of file
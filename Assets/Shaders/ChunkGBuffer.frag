@@ -1,20 +1,34 @@
 #version 330 core
 
-layout (location = 0) out vec4 g_Position;
-layout (location = 1) out vec4 g_Normal;
-layout (location = 2) out vec4 g_Albedo;
+layout (location = 0) out vec2 g_Normal;
+layout (location = 1) out vec4 g_Albedo;
+layout (location = 2) out float g_ViewDepth;
 
 in vec2 v_TexCoords;
-in vec3 v_Normal;
-in vec3 v_FragPos;
+flat in vec3 v_Normal;
 in float v_AmbientFactor;
+in float v_ViewDepth;
 
 uniform sampler2D u_TextureAtlas;
 
+// Octahedral, in steps of 1/127 around 128, which the faces' normals land on
+// exactly
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 e = n.xy;
+	if (n.z < 0.0)
+	{
+		vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+		e = (1.0 - abs(n.yx)) * signs;
+	}
+	return (e * 127.0 + 128.0) / 255.0;
+}
+
 void main()
 {
-	g_Position = vec4(v_FragPos, 1.0);
-	g_Normal = vec4(normalize(v_Normal), 1.0);
+	g_Normal = EncodeNormal(v_Normal);
+	g_ViewDepth = v_ViewDepth;
 	g_Albedo = texture(u_TextureAtlas, v_TexCoords);
 	//g_Albedo = vec4(v_AmbientFactor, v_AmbientFactor, v_AmbientFactor, 1.0);
 	if (g_Albedo.a < 0.05) discard;
@@ -11,11 +11,14 @@ layout (std140) uniform Matrices
 };
 
 uniform ivec3 u_Position = ivec3(0);
+// Width of the chunk's blocks, above one for LOD chunks
+uniform int u_Scale = 1;
 
 out vec2 v_TexCoords;
-out vec3 v_Normal;
-out vec3 v_FragPos;
+// In world space
+flat out vec3 v_Normal;
 out float v_AmbientFactor;
+out float v_ViewDepth;
 
 const vec3 k_FaceNormals[6] = vec3[]
 (
@@ -41,7 +44,7 @@ void main()
 	float v = (a_Data >> 27u) & 0x1u;
 	uint face = (a_Data >> 28u) & 0x7u;
 
-	v_Normal = mat3(u_View) * k_FaceNormals[face];
+	v_Normal = k_FaceNormals[face];
 
 	v_TexCoords = vec2(
 		((textureIndex & 0xFu) + u) / 16.0,
@@ -50,9 +53,9 @@ void main()
 
 	v_AmbientFactor = float(a_DataExtended & 0x3u) / 3.0;
 
-	vec4 worldPosition = vec4(u_Position + chunkOffset, 1.0);
+	vec4 worldPosition = vec4(u_Position + chunkOffset * u_Scale, 1.0);
 	vec4 viewPosition = u_View * worldPosition;
-	v_FragPos = vec3(viewPosition);
+	v_ViewDepth = -viewPosition.z;
 
 	gl_Position = u_Projection * viewPosition;
 }
\ No newline at end of file
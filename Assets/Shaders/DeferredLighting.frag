@@ -5,27 +5,59 @@ layout (std140) uniform Matrices
 	mat4 u_Projection;
 	mat4 u_View;
 	mat4 u_LightSpace[4];
+	mat4 u_InverseProjection;
+	mat4 u_InverseView;
 };
 
 in vec2 v_TexCoords;
 
 out vec4 FragColor;
 
-uniform sampler2D u_PositionSampler;
 uniform sampler2D u_NormalSampler;
 uniform sampler2D u_AlbedoSampler;
-uniform sampler2DArray u_ShadowMap;
+// Linear, along the view direction, not the depth buffer's
+uniform sampler2D u_ViewDepthSampler;
+// Of the G-buffer's textures, the corner that was drawn into
+uniform vec2 u_ResolutionScale;
+// Atlas of every cascade's shadow map
+uniform sampler2D u_ShadowMap;
+// Corner and size of each cascade's square, in texture coordinates
+uniform vec4 u_CascadeRects[4];
+uniform int u_PcfRadius;
 
 uniform vec4 u_SubfrustaPlanes;
+// In world space
 uniform vec3 u_LightDir;
 
 const vec3 k_LightColor = vec3(1.0, 1.0, 0.8);
 const float k_AmbientFactor = 0.4;
 const float k_DiffuseFactor = 0.8;
 
+vec3 DecodeNormal(vec2 encoded)
+{
+	vec2 e = (round(encoded * 255.0) - 128.0) / 127.0;
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+	{
+		vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+		n.xy = (1.0 - abs(n.yx)) * signs;
+	}
+	return normalize(n);
+}
+
+vec3 ViewPosition(vec2 texCoords, float viewDepth)
+{
+	// Through the pixel, on the near plane
+	vec4 ray = u_InverseProjection * vec4(texCoords * 2.0 - 1.0, -1.0, 1.0);
+	ray.xyz /= ray.w;
+	return ray.xyz * (viewDepth / -ray.z);
+}
+
 float ShadowCalculation(vec3 fragPos)
 {
 	float viewDepth = -fragPos.z;
+	// Past the last cascade, where only LOD chunks are drawn
+	if (viewDepth >= u_SubfrustaPlanes[3]) return 0.0;
 
 	int layer = 3;
 	for (int i = 0; i < 3; i++)
@@ -37,27 +69,34 @@ float ShadowCalculation(vec3 fragPos)
 		}
 	}
 
-	vec4 fragPosLightSpace = u_LightSpace[layer] * inverse(u_View) * vec4(fragPos, 1.0);
+	vec4 fragPosLightSpace = u_LightSpace[layer] * u_InverseView * vec4(fragPos, 1.0);
 
 	vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
 	projCoords = (projCoords + 1.0) / 2.0;
 
 	vec2 texelSize = 1.0 / vec2(textureSize(u_ShadowMap, 0));
+	vec4 rect = u_CascadeRects[layer];
+	vec2 atlasCoords = rect.xy + projCoords.xy * rect.zw;
+	// Taps stay inside the cascade's own square
+	vec2 minCoords = rect.xy + 0.5 * texelSize;
+	vec2 maxCoords = rect.xy + rect.zw - 0.5 * texelSize;
 	float currentDepth = projCoords.z;
 
 	float shadow = 0.0;
 	float bias = 0.0015 / sqrt(u_SubfrustaPlanes[layer]);
 	 
-	for (int x = -1; x <= 1; x++)
+	for (int x = -u_PcfRadius; x <= u_PcfRadius; x++)
 	{
-		for (int y = -1; y <= 1; y++)
+		for (int y = -u_PcfRadius; y <= u_PcfRadius; y++)
 		{
-			float pcfDepth = texture(u_ShadowMap, vec3(projCoords.xy + vec2(x, y) * texelSize, layer)).r;
+			vec2 coords = clamp(atlasCoords + vec2(x, y) * texelSize, minCoords, maxCoords);
+			float pcfDepth = texture(u_ShadowMap, coords).r;
 			shadow += (currentDepth - bias ) > pcfDepth ? 1.0 : 0.0;
 		}
 	}
 	
-	shadow /= 9.0;
+	float taps = float(2 * u_PcfRadius + 1);
+	shadow /= taps * taps;
 
 	if (projCoords.z > 1.0) return 0.0;
 	return shadow;
@@ -65,9 +104,9 @@ float ShadowCalculation(vec3 fragPos)
 
 void main()
 {
-	vec3 fragPos = texture(u_PositionSampler, v_TexCoords).rgb;
-	vec3 normal = texture(u_NormalSampler, v_TexCoords).rgb;
-	vec4 albedoSample = texture(u_AlbedoSampler, v_TexCoords);
+	vec2 gBufferCoords = v_TexCoords * u_ResolutionScale;
+	vec3 normal = DecodeNormal(texture(u_NormalSampler, gBufferCoords).rg);
+	vec4 albedoSample = texture(u_AlbedoSampler, gBufferCoords);
 	vec3 albedo = albedoSample.rgb;
 	float occlusion = albedoSample.a;
 
@@ -82,6 +121,7 @@ void main()
 	float diff = max(dot(normal, -u_LightDir), 0.0) * k_DiffuseFactor;
 	vec3 diffuse = diff * albedo;
 		
-	float shadow = ShadowCalculation(fragPos);
+	float viewDepth = texture(u_ViewDepthSampler, gBufferCoords).r;
+	float shadow = ShadowCalculation(ViewPosition(v_TexCoords, viewDepth));
 	FragColor = vec4(ambient + (1.0 - shadow) * diffuse, 1.0);
 }
\ No newline at end of file
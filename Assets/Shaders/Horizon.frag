@@ -0,0 +1,31 @@
+#version 330 core
+
+layout (location = 0) out vec2 g_Normal;
+layout (location = 1) out vec4 g_Albedo;
+layout (location = 2) out float g_ViewDepth;
+
+in vec3 v_Normal;
+in vec3 v_Color;
+in float v_ViewDepth;
+
+// Octahedral, in steps of 1/127 around 128, which the faces' normals land on
+// exactly
+vec2 EncodeNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 e = n.xy;
+	if (n.z < 0.0)
+	{
+		vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+		e = (1.0 - abs(n.yx)) * signs;
+	}
+	return (e * 127.0 + 128.0) / 255.0;
+}
+
+void main()
+{
+	g_Normal = EncodeNormal(normalize(v_Normal));
+	g_ViewDepth = v_ViewDepth;
+	// No ambient occlusion
+	g_Albedo = vec4(v_Color, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 330 core
+
+layout (location = 0) in vec3 a_Position;
+layout (location = 1) in vec3 a_Normal;
+layout (location = 2) in uvec4 a_Color;
+
+layout (std140) uniform Matrices
+{
+	mat4 u_Projection;
+	mat4 u_View;
+	mat4 u_LightSpace[4];
+};
+
+// The horizon's own projection, with near and far planes past the chunks
+uniform mat4 u_Transform;
+
+// In world space
+out vec3 v_Normal;
+out vec3 v_Color;
+out float v_ViewDepth;
+
+void main()
+{
+	vec4 viewPosition = u_View * vec4(a_Position, 1.0);
+	v_Normal = a_Normal;
+	v_ViewDepth = -viewPosition.z;
+	v_Color = vec3(a_Color.rgb) / 255.0;
+
+	gl_Position = u_Transform * viewPosition;
+}
\ No newline at end of file
@@ -10,6 +10,8 @@ layout (std140) uniform Matrices
 };
 
 uniform ivec3 u_Position = ivec3(0);
+// Width of the chunk's blocks, above one for LOD chunks
+uniform int u_Scale = 1;
 
 out vec2 v_TexCoords;
 out vec3 v_Normal;
@@ -47,9 +49,9 @@ void main()
 		(15u - (textureIndex >> 4u) + v) / 16.0
 	);
 
-	v_FragPos = u_Position + chunkOffset;
+	v_FragPos = u_Position + chunkOffset * u_Scale;
 
-	vec4 worldPosition = vec4(u_Position + chunkOffset, 1.0);
+	vec4 worldPosition = vec4(u_Position + chunkOffset * u_Scale, 1.0);
 
 	gl_Position = u_Projection * u_View * worldPosition;
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+// Headless meshing benchmark. Generates a fixed patch of terrain with the
+// regular WorldGenerator, then meshes every chunk of it on one thread and on
+// all hardware threads with MeshBuilder directly, no window or GL context.
+//
+// Usage: MeshingBenchmark [threads]
+
+#include "Core/Logger.h"
+#include "Memory/ChunkAllocator.h"
+#include "World/Chunk.h"
+#include "World/ChunkUtils.h"
+#include "World/MeshBenchmark.h"
+#include "World/MeshBuilder.h"
+#include "World/WorldGenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Chunks meshed per axis, the generated patch has a one chunk border around
+// them so that every meshed chunk has all of its neighbors
+static constexpr int k_GridSize = 8;
+static constexpr int k_GridHeight = 4;
+static constexpr int k_Passes = 5;
+
+struct Terrain
+{
+    std::unordered_map<ChunkCoords, Chunk*> Chunks;
+    std::vector<const Chunk*> Meshed;
+};
+
+static Terrain GenerateTerrain()
+{
+    Terrain terrain{};
+    WorldGenerator generator{};
+
+    // Generated bottom up so that trees find the chunks they grow into
+    for (int y = -1; y <= k_GridHeight; y++)
+    {
+        for (int z = -1; z <= k_GridSize; z++)
+        {
+            for (int x = -1; x <= k_GridSize; x++)
+            {
+                const ChunkCoords coords{x, y, z};
+                Chunk* const chunk = new Chunk{coords};
+                for (int dz = -1; dz <= 1; dz++)
+                {
+                    for (int dy = -1; dy <= 1; dy++)
+                    {
+                        for (int dx = -1; dx <= 1; dx++)
+                        {
+                            auto it = terrain.Chunks.find(
+                                coords + ChunkCoords{dx, dy, dz});
+                            if (it == terrain.Chunks.end() ||
+                                (dx == 0 && dy == 0 && dz == 0))
+                                continue;
+                            chunk->LinkNeighbor(
+                                it->second,
+                                ChunkUtils::NeighborIndex(dx, dy, dz));
+                        }
+                    }
+                }
+                generator.GenerateChunk(*chunk);
+                terrain.Chunks[coords] = chunk;
+            }
+        }
+    }
+
+    for (const auto& [coords, chunk] : terrain.Chunks)
+    {
+        if (coords.X >= 0 && coords.X < k_GridSize && coords.Y >= 0 &&
+            coords.Y < k_GridHeight && coords.Z >= 0 &&
+            coords.Z < k_GridSize)
+            terrain.Meshed.push_back(chunk);
+    }
+    return terrain;
+}
+
+// Meshes all chunks k_Passes times split over the given number of threads,
+// each with its own builder. Returns the seconds taken
+static double MeshAll(const std::vector<const Chunk*>& chunks,
+                      unsigned numThreads, size_t& numVertices)
+{
+    using namespace std::chrono;
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> vertices{0};
+    const size_t numJobs = chunks.size() * k_Passes;
+
+    auto worker = [&]()
+    {
+        MeshBuilder builder{};
+        size_t localVertices = 0;
+        for (size_t job = next++; job < numJobs; job = next++)
+        {
+            builder.Build(*chunks[job % chunks.size()]);
+            localVertices += builder.NumVertices();
+        }
+        vertices += localVertices;
+    };
+
+    const steady_clock::time_point start = steady_clock::now();
+    std::vector<std::thread> threads{};
+    for (unsigned i = 1; i < numThreads; i++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+    const steady_clock::time_point end = steady_clock::now();
+
+    numVertices = vertices / k_Passes;
+    return duration<double>(end - start).count();
+}
+
+static void Report(const char* label, unsigned numThreads, double seconds,
+                   size_t numChunks, size_t numVertices)
+{
+    const double builds = static_cast<double>(numChunks * k_Passes);
+    const double chunksPerSecond = builds / seconds;
+    const double nsPerBlock =
+        seconds * 1e9 / (builds * static_cast<double>(CHUNK_VOLUME));
+    const double verticesPerChunk =
+        static_cast<double>(numVertices) / static_cast<double>(numChunks);
+    LOG_INFO("{} ({} threads): {:.0f} chunks/s, {:.2f} ns/block, "
+             "{:.0f} vertices/chunk",
+             label, numThreads, chunksPerSecond, nsPerBlock,
+             verticesPerChunk);
+}
+
+int main(int argc, char** argv)
+{
+    g_Logger.Init();
+
+    const unsigned hardwareThreads =
+        std::max(1u, std::thread::hardware_concurrency());
+    const unsigned numThreads =
+        argc > 1 ? static_cast<unsigned>(std::max(1, std::atoi(argv[1])))
+                 : hardwareThreads;
+
+    constexpr size_t maxChunks =
+        (k_GridSize + 2) * (k_GridSize + 2) * (k_GridHeight + 2) + 64;
+    g_ChunkAllocator.Init(maxChunks);
+
+    Terrain terrain = GenerateTerrain();
+    const size_t numChunks = terrain.Meshed.size();
+    LOG_INFO("Meshing {} generated chunks {} times", numChunks, k_Passes);
+
+    size_t numVertices = 0;
+    const double singleSeconds = MeshAll(terrain.Meshed, 1, numVertices);
+    Report("Single threaded", 1, singleSeconds, numChunks, numVertices);
+
+    const double multiSeconds =
+        MeshAll(terrain.Meshed, numThreads, numVertices);
+    Report("Multi threaded", numThreads, multiSeconds, numChunks,
+           numVertices);
+
+    MeshBenchmark::Run();
+
+    for (auto& [coords, chunk] : terrain.Chunks)
+        delete chunk;
+    g_ChunkAllocator.Free();
+    return 0;
+}
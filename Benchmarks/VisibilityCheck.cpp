@@ -0,0 +1,290 @@
+// Headless checks of cave and occlusion culling. Builds chunks by hand, then
+// checks which of their faces ChunkVisibility connects, that the CaveCuller
+// search hides everything past a sealed cave around the camera, and that the
+// OcclusionCuller never hides a chunk showing past an occluder's edge, no
+// window or GL context.
+//
+// Usage: VisibilityCheck, exits with 1 if any check fails
+
+#include "Core/Logger.h"
+#include "Memory/ChunkAllocator.h"
+#include "Rendering/CaveCuller.h"
+#include "Rendering/OcclusionCuller.h"
+#include "World/Chunk.h"
+#include "World/ChunkUtils.h"
+#include "World/ChunkVisibility.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <glm/gtc/matrix_transform.hpp>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint8_t k_Last = CHUNK_DIMENSION - 1;
+static constexpr uint8_t k_Middle = CHUNK_DIMENSION / 2;
+static constexpr size_t k_NumFaces = static_cast<size_t>(BlockFace::Count);
+
+// Chunks out to this many from the camera's on every axis
+static constexpr int k_CaveRadius = 2;
+
+static int s_Failures = 0;
+
+static void Check(bool passed, const char* what)
+{
+    if (passed)
+    {
+        LOG_INFO("Passed: {}", what);
+        return;
+    }
+    LOG_ERROR("Failed: {}", what);
+    s_Failures++;
+}
+
+static uint8_t FaceBit(BlockFace face)
+{
+    return static_cast<uint8_t>(1u << static_cast<int>(face));
+}
+
+// Whether the chunk's faces connect to exactly the ones in each face's mask,
+// indexed by BlockFace. A face's own bit is ignored
+static bool ConnectsExactly(const Chunk& chunk,
+                            const std::array<uint8_t, k_NumFaces>& expected)
+{
+    const ChunkVisibility visibility =
+        ChunkVisibility::Compute(chunk.GetOccupancy());
+    for (size_t a = 0; a < k_NumFaces; a++)
+    {
+        for (size_t b = 0; b < k_NumFaces; b++)
+        {
+            if (a == b)
+                continue;
+            const bool connected = visibility.Connects(
+                static_cast<BlockFace>(a), static_cast<BlockFace>(b));
+            if (connected != (((expected[a] >> b) & 1u) != 0))
+                return false;
+        }
+    }
+    return true;
+}
+
+static void FillChunk(Chunk& chunk, BlockType blockType)
+{
+    chunk.FillBlocks(blockType, {0, 0, 0}, {k_Last, k_Last, k_Last});
+}
+
+// One block wide, through the middle of the chunk from its NegX face to its
+// PosX face
+static void DigTunnelX(Chunk& chunk)
+{
+    chunk.FillBlocks(BlockType::Air, {0, k_Middle, k_Middle},
+                     {k_Last, k_Middle, k_Middle});
+}
+
+static void CheckConnectivity()
+{
+    std::array<uint8_t, k_NumFaces> none{};
+    std::array<uint8_t, k_NumFaces> all{};
+    all.fill(ChunkVisibility::ALL_FACES);
+
+    Chunk chunk{{0, 0, 0}};
+    Check(ConnectsExactly(chunk, all), "an empty chunk connects all faces");
+
+    FillChunk(chunk, BlockType::Stone);
+    Check(ConnectsExactly(chunk, none), "a solid chunk connects no faces");
+
+    // Air inside a shell one block thick
+    chunk.FillBlocks(BlockType::Air, {1, 1, 1},
+                     {k_Last - 1, k_Last - 1, k_Last - 1});
+    Check(ConnectsExactly(chunk, none), "a hollow chunk connects no faces");
+
+    FillChunk(chunk, BlockType::Stone);
+    DigTunnelX(chunk);
+    std::array<uint8_t, k_NumFaces> tunnel{};
+    tunnel[static_cast<size_t>(BlockFace::NegX)] = FaceBit(BlockFace::PosX);
+    tunnel[static_cast<size_t>(BlockFace::PosX)] = FaceBit(BlockFace::NegX);
+    Check(ConnectsExactly(chunk, tunnel),
+          "a tunnel connects only the faces at its ends");
+}
+
+struct Cave
+{
+    std::unordered_map<ChunkCoords, Chunk*> Chunks;
+    std::vector<const Chunk*> All;
+};
+
+// An empty chunk for the camera, walled in by solid chunks on all sides and
+// corners, with empty chunks around that
+static Cave BuildCave()
+{
+    Cave cave{};
+    for (int z = -k_CaveRadius; z <= k_CaveRadius; z++)
+    {
+        for (int y = -k_CaveRadius; y <= k_CaveRadius; y++)
+        {
+            for (int x = -k_CaveRadius; x <= k_CaveRadius; x++)
+            {
+                const ChunkCoords coords{x, y, z};
+                Chunk* const chunk = new Chunk{coords};
+                if (std::max({std::abs(x), std::abs(y), std::abs(z)}) == 1)
+                    FillChunk(*chunk, BlockType::Stone);
+                cave.Chunks[coords] = chunk;
+                cave.All.push_back(chunk);
+            }
+        }
+    }
+
+    for (auto& [coords, chunk] : cave.Chunks)
+    {
+        for (int dz = -1; dz <= 1; dz++)
+        {
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    const size_t index = ChunkUtils::NeighborIndex(dx, dy, dz);
+                    const auto it =
+                        cave.Chunks.find(coords + ChunkCoords{dx, dy, dz});
+                    // Links both ways, so only toward the later half
+                    if (it != cave.Chunks.end() &&
+                        index > ChunkUtils::k_CenterNeighborSlot)
+                        chunk->LinkNeighbor(it->second, index);
+                }
+            }
+        }
+    }
+
+    // The visibility the search reads is computed along with the mesh
+    for (auto& [coords, chunk] : cave.Chunks)
+        chunk->BuildMesh();
+    return cave;
+}
+
+// Planes far enough out that every chunk is in the frustum
+static std::array<Plane, 6> EverythingFrustum()
+{
+    constexpr float far = 1e6f;
+    return {Plane{{1.0f, 0.0f, 0.0f}, {-far, 0.0f, 0.0f}},
+            Plane{{-1.0f, 0.0f, 0.0f}, {far, 0.0f, 0.0f}},
+            Plane{{0.0f, 1.0f, 0.0f}, {0.0f, -far, 0.0f}},
+            Plane{{0.0f, -1.0f, 0.0f}, {0.0f, far, 0.0f}},
+            Plane{{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -far}},
+            Plane{{0.0f, 0.0f, -1.0f}, {0.0f, 0.0f, far}}};
+}
+
+static bool IsVisible(const std::vector<const Chunk*>& visible,
+                      const Chunk* chunk)
+{
+    return std::find(visible.begin(), visible.end(), chunk) != visible.end();
+}
+
+static void CheckCaveCulling()
+{
+    Cave cave = BuildCave();
+    const Chunk* const camera = cave.Chunks.at({0, 0, 0});
+    const std::array<Plane, 6> frustum = EverythingFrustum();
+
+    CaveCuller culler{};
+    std::vector<const Chunk*> visible{};
+    culler.Traverse(camera, frustum);
+    culler.Filter(cave.All, visible);
+
+    // The walls on the edges and corners are behind the ones on the sides
+    bool wallsVisible = true;
+    bool outsideHidden = true;
+    for (const auto& [coords, chunk] : cave.Chunks)
+    {
+        const int steps =
+            std::abs(coords.X) + std::abs(coords.Y) + std::abs(coords.Z);
+        const int distance = std::max(
+            {std::abs(coords.X), std::abs(coords.Y), std::abs(coords.Z)});
+        if (steps <= 1)
+            wallsVisible = wallsVisible && IsVisible(visible, chunk);
+        else if (distance > 1)
+            outsideHidden = outsideHidden && !IsVisible(visible, chunk);
+    }
+    Check(wallsVisible, "the side walls of a sealed cave stay visible");
+    Check(outsideHidden, "everything past a sealed cave is hidden");
+
+    Chunk* const wall = cave.Chunks.at({1, 0, 0});
+    DigTunnelX(*wall);
+    wall->BuildMesh();
+    culler.Traverse(camera, frustum);
+    culler.Filter(cave.All, visible);
+    Check(IsVisible(visible, cave.Chunks.at({2, 0, 0})),
+          "a tunnel through the wall shows the chunk behind it");
+    Check(!IsVisible(visible, cave.Chunks.at({-2, 0, 0})),
+          "a tunnel through one wall keeps the opposite side hidden");
+
+    for (auto& [coords, chunk] : cave.Chunks)
+        delete chunk;
+}
+
+// Whether the chunk is left in the list after occlusion culling from the
+// camera, looking down -Z
+static bool SurvivesOcclusion(OcclusionCuller& culler,
+                              const std::vector<const Chunk*>& chunks,
+                              const Chunk* chunk, const glm::vec3& cameraPos)
+{
+    const float aspect = static_cast<float>(OcclusionCuller::WIDTH) /
+                         static_cast<float>(OcclusionCuller::HEIGHT);
+    const glm::mat4 viewProjection =
+        glm::perspective(glm::radians(90.0f), aspect, 0.1f, 1000.0f) *
+        glm::lookAt(cameraPos, cameraPos + glm::vec3{0.0f, 0.0f, -1.0f},
+                    glm::vec3{0.0f, 1.0f, 0.0f});
+
+    std::vector<const Chunk*> visible = chunks;
+    std::vector<const Chunk*> water{};
+    culler.Begin(visible, water, viewProjection, cameraPos);
+    culler.End(visible, water);
+    return IsVisible(visible, chunk);
+}
+
+static void CheckOcclusionCulling()
+{
+    // A solid chunk, and an empty one the same size two chunks behind it
+    Chunk occluder{{0, 0, -2}};
+    FillChunk(occluder, BlockType::Stone);
+    occluder.BuildMesh();
+    Chunk behind{{0, 0, -4}};
+    behind.BuildMesh();
+    const std::vector<const Chunk*> chunks{&occluder, &behind};
+
+    OcclusionCuller culler{};
+    const float middle = static_cast<float>(k_Middle);
+    Check(!SurvivesOcclusion(culler, chunks, &behind,
+                             {middle, middle, 0.0f}),
+          "a chunk wholly behind an occluder is hidden");
+
+    // Just past the occluder's right side, the chunk behind shows in a
+    // sliver down to a fraction of a pixel wide
+    bool edgeVisible = true;
+    for (int step = 1; step <= 64; step++)
+    {
+        const glm::vec3 cameraPos{CHUNK_DIMENSION + step * 0.02f, middle,
+                                  0.0f};
+        edgeVisible = edgeVisible &&
+                      SurvivesOcclusion(culler, chunks, &behind, cameraPos);
+    }
+    Check(edgeVisible, "a chunk showing past an occluder's edge is kept");
+}
+
+int main()
+{
+    g_Logger.Init();
+
+    constexpr int caveSize = 2 * k_CaveRadius + 1;
+    g_ChunkAllocator.Init(caveSize * caveSize * caveSize + 16);
+
+    CheckConnectivity();
+    CheckCaveCulling();
+    CheckOcclusionCulling();
+
+    g_ChunkAllocator.Free();
+    if (s_Failures > 0)
+    {
+        LOG_ERROR("{} checks failed", s_Failures);
+        return 1;
+    }
+    LOG_INFO("All checks passed");
+    return 0;
+}
@@ -20,7 +20,7 @@ Application::Application()
     g_ChunkAllocator.Init(MathUtils::Cube(Config::ChunkLoadDistance + 1) * 16);
     m_World.Init();
     m_Camera.AttachView(m_World.GetPlayerView());
-    m_UIOverlay.Init(&m_Window, &m_Camera, &m_World);
+    m_UIOverlay.Init(&m_Window, &m_Camera, &m_World, &m_Renderer);
 
     LOG_INFO("Application initialized");
 }
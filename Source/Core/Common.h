@@ -9,6 +9,11 @@
 #define unreachable() __builtin_unreachable()
 #endif
 
+// SSE is part of every x86-64 target, anything else takes the scalar paths
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define VOXELS_SSE
+#endif
+
 inline constexpr int CHUNK_DIMENSION = 32;
 inline constexpr int CHUNK_AREA = CHUNK_DIMENSION * CHUNK_DIMENSION;
 inline constexpr int CHUNK_VOLUME =
@@ -20,4 +25,14 @@ inline constexpr size_t CHUNK_VOLUME_U =
     CHUNK_DIMENSION_U * CHUNK_DIMENSION_U * CHUNK_DIMENSION_U;
 inline constexpr size_t CHUNK_COORD_MASK = CHUNK_DIMENSION_U - 1;
 inline constexpr size_t CHUNK_COORD_BIT_COUNT =
-    std::popcount(static_cast<size_t>(CHUNK_COORD_MASK));
\ No newline at end of file
+    std::popcount(static_cast<size_t>(CHUNK_COORD_MASK));
+
+// The splitmix64 finalizer, a cheap hash with every input bit reaching every
+// output bit
+inline constexpr uint64_t SplitMix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
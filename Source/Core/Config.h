@@ -12,4 +12,77 @@ inline constexpr int ChunkRenderDistance = 8;
 inline constexpr int TickRate = 20;
 inline constexpr float MouseSensitivity = 0.05f;
 inline constexpr float HorizontalFOV = 90.0f;
+// Per tick time budgets of each world streaming stage, in microseconds
+inline constexpr int GenerateBudgetMicros = 4000;
+inline constexpr int MeshBudgetMicros = 4000;
+inline constexpr int UploadBudgetMicros = 1500;
+inline constexpr int UnloadBudgetMicros = 500;
+inline constexpr int LodBudgetMicros = 2000;
+inline constexpr int HorizonBudgetMicros = 1000;
+// Once the regular load queue is empty, chunks around where the player is
+// predicted to be this far ahead get generated, up to a memory budget
+inline constexpr float PrefetchLookaheadSeconds = 3.0f;
+inline constexpr int PrefetchBudgetMegabytes = 64;
+// Finished chunk meshes are kept on disk, relative to the working directory,
+// so that revisited regions and restarts skip meshing
+inline constexpr bool EnableMeshCache = true;
+inline constexpr const char* MeshCacheDirectory = "MeshCache";
+// Least recently used entries get deleted past this
+inline constexpr int MeshCacheBudgetMegabytes = 512;
+// Rings of coarser terrain drawn past the regular chunks, each level's blocks
+// twice the size of the last. Every level spans LodRingRadius of its own
+// chunks around the player, except the coarsest, which reaches LodOuterRadius.
+// The regular chunks only get drawn inside the finest level's ring
+inline constexpr int LodLevels = 3;
+inline constexpr int LodRingRadius = 3;
+inline constexpr int LodOuterRadius = 6;
+// Skips regular chunks that terrain hides from the camera's chunk, found by
+// searching through the chunks whose faces can see each other
+inline constexpr bool EnableCaveCulling = true;
+// Skips chunks hidden behind the solid blocks of the nearest chunks, drawn
+// into a small depth buffer on another thread
+inline constexpr bool EnableOcclusionCulling = true;
+inline constexpr int OcclusionBufferWidth = 256;
+inline constexpr int OcclusionBufferHeight = 128;
+// Of the nearest chunks
+inline constexpr int OcclusionMaxOccluders = 192;
+// Shadow cascades are only drawn again once they move, or the chunks in them
+// get remeshed. They move once the camera's subfrustum is this far, as a
+// fraction of its radius, from where they were last drawn
+inline constexpr bool EnableShadowCaching = true;
+inline constexpr float ShadowCascadeSlack = 0.25f;
+// The farthest cascades pick up remeshed chunks only every this many frames,
+// one of them at a time
+inline constexpr int ShadowStaggeredCascades = 2;
+inline constexpr int ShadowRefreshInterval = 8;
+// Depth range of each cascade toward the light, in blocks past its subfrustum.
+// Casters farther still are clamped to the near plane rather than clipped
+inline constexpr float ShadowCasterDistance = 256.0f;
+// Shadow cascades are drawn from a separate mesh of each chunk, with the
+// opaque faces merged into as few rectangles as possible
+inline constexpr bool EnableShadowMeshes = true;
+// Shadow quality tier to start with, from 0 (Low) to 3 (Ultra). It can be
+// changed from the overlay
+inline constexpr int DefaultShadowQuality = 2;
+// The G-buffer and lighting are drawn at a fraction of the window's
+// resolution, in steps down to the minimum, and scaled up to it after. The
+// fraction drops while the GPU takes longer than the target on a frame, and
+// climbs back while it takes less than the headroom's share of the target.
+// Once changed it holds for some frames, so that the times can catch up
+inline constexpr bool EnableDynamicResolution = true;
+inline constexpr float DynamicResolutionTargetMs = 14.0f;
+inline constexpr float DynamicResolutionHeadroom = 0.8f;
+inline constexpr float DynamicResolutionMinScale = 0.5f;
+inline constexpr float DynamicResolutionStep = 0.05f;
+inline constexpr int DynamicResolutionSettleFrames = 8;
+// Chunks to the edge of everything that gets drawn
+inline constexpr int ViewDistance =
+    LodLevels > 0 ? (LodOuterRadius + 1) << LodLevels : ChunkRenderDistance;
+// Heightfield terrain drawn past all chunks, as nested grids of
+// HorizonGridSize quads. The first level's samples are HorizonSpacing blocks
+// apart, every further level's twice as far
+inline constexpr bool EnableHorizon = true;
+inline constexpr int HorizonLevels = 5;
+inline constexpr int HorizonGridSize = 128;
+inline constexpr int HorizonSpacing = 32;
 } // namespace Config
\ No newline at end of file
@@ -9,7 +9,13 @@
 struct DebugState
 {
     int Remeshes = 0;
+    int RemeshedSections = 0;
+    int RemeshesSkipped = 0;
+    int CachedMeshes = 0;
     int Loaded = 0;
+    int Unloaded = 0;
+    int Prefetched = 0;
+    int Uploads = 0;
     int DrawCalls = 0;
     int Frames = 0;
     int Ticks = 0;
@@ -17,7 +23,13 @@ struct DebugState
     void Reset()
     {
         Remeshes = 0;
+        RemeshedSections = 0;
+        RemeshesSkipped = 0;
+        CachedMeshes = 0;
         Loaded = 0;
+        Unloaded = 0;
+        Prefetched = 0;
+        Uploads = 0;
         DrawCalls = 0;
         Frames = 0;
         Ticks = 0;
@@ -35,10 +47,22 @@ struct std::formatter<DebugState>
     auto format(const DebugState& debugState, std::format_context& ctx) const
     {
         return std::format_to(ctx.out(),
-                              "Debug Info:\nRemeshed chunks: {}\nLoaded "
-                              "chunks: {}\nDraw calls: {}\nFPS: {}\nTPS: {}",
-                              debugState.Remeshes, debugState.Loaded,
-                              debugState.DrawCalls, debugState.Frames,
-                              debugState.Ticks);
+                              "Debug Info:\n"
+                              "Remeshed chunks: {} ({} sections)\n"
+                              "Skipped remeshes: {}\n"
+                              "Meshes from cache: {}\n"
+                              "Loaded chunks: {}\n"
+                              "Unloaded chunks: {}\n"
+                              "Prefetched chunks: {}\n"
+                              "Mesh uploads: {}\n"
+                              "Draw calls: {}\n"
+                              "FPS: {}\n"
+                              "TPS: {}",
+                              debugState.Remeshes, debugState.RemeshedSections,
+                              debugState.RemeshesSkipped,
+                              debugState.CachedMeshes, debugState.Loaded,
+                              debugState.Unloaded, debugState.Prefetched,
+                              debugState.Uploads, debugState.DrawCalls,
+                              debugState.Frames, debugState.Ticks);
     }
 };
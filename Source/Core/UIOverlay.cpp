@@ -6,16 +6,22 @@
 #include "Window.h"
 #include "World/World.h"
 #include "Rendering/Camera.h"
+#include "Rendering/Renderer.h"
 #include "World/Coordinates.h"
 #include "ECS/Components.h"
 #include "ECS/ECS.h"
 #include "World/Block.h"
+#include "World/EditBenchmark.h"
+#include "World/MeshBenchmark.h"
+#include <bit>
 
-void UIOverlay::Init(Window* window, Camera* camera, World* world)
+void UIOverlay::Init(Window* window, Camera* camera, World* world,
+                     Renderer* renderer)
 {
     m_Window = window;
     m_Camera = camera;
     m_World = world;
+    m_Renderer = renderer;
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -66,6 +72,14 @@ void UIOverlay::BeginRender()
         {
             m_World->SetPlayerActiveBlock(static_cast<BlockType>(option + 1));
         }
+        if (ImGui::Button("Run edit benchmark"))
+        {
+            EditBenchmark::Run(*m_World);
+        }
+        if (ImGui::Button("Run mesh benchmark"))
+        {
+            MeshBenchmark::Run();
+        }
     }
     if (ImGui::CollapsingHeader("Camera"))
     {
@@ -83,6 +97,91 @@ void UIOverlay::BeginRender()
     if (ImGui::CollapsingHeader("Light"))
     {
     }
+    if (ImGui::CollapsingHeader("Rendering"))
+    {
+        const CullingStats culling = m_Renderer->GetCullingStats();
+        ImGui::Text("Frustum culling: %.1f us", culling.Micros);
+        ImGui::Text("Clusters: %d tested, %d skipped", culling.ClustersTested,
+                    culling.ClustersSkipped);
+        ImGui::Text("Chunks: %d tested, %d visible", culling.ChunksTested,
+                    culling.ChunksVisible);
+
+        const CaveCullingStats& caveCulling = m_Renderer->GetCaveCullingStats();
+        ImGui::Text("Cave culling: %.1f us", caveCulling.Micros);
+        ImGui::Text("Chunks: %d visited, %d hidden", caveCulling.ChunksVisited,
+                    caveCulling.ChunksHidden);
+
+        const OcclusionStats& occlusion = m_Renderer->GetOcclusionStats();
+        ImGui::Text("Occlusion culling: %.1f us, %.1f us waited",
+                    occlusion.Micros, occlusion.WaitMicros);
+        ImGui::Text("Occluders: %d", occlusion.Occluders);
+        const float occlusionRate =
+            occlusion.ChunksTested > 0
+                ? 100.0f * occlusion.ChunksHidden / occlusion.ChunksTested
+                : 0.0f;
+        ImGui::Text("Chunks: %d tested, %d hidden (%.1f%%)",
+                    occlusion.ChunksTested, occlusion.ChunksHidden,
+                    occlusionRate);
+
+        const ShadowStats& shadows = m_Renderer->GetShadowStats();
+        ImGui::Text("Shadow cascades: %d drawn, %d chunks",
+                    shadows.CascadesDrawn, shadows.ChunksDrawn);
+        ImGui::Text("Cascades waiting for their turn: %d",
+                    std::popcount(shadows.StaleCascades));
+
+        const ShadowQuality quality = m_Renderer->GetShadowQuality();
+        int option = static_cast<int>(quality);
+        if (ImGui::Combo("Shadow quality", &option, GetAllShadowQualityNames(),
+                         static_cast<int>(ShadowQuality::Count)))
+        {
+            m_Renderer->SetShadowQuality(static_cast<ShadowQuality>(option));
+        }
+        const ShadowAtlasLayout& atlas = m_Renderer->GetShadowAtlas();
+        const bool floatDepth = GetShadowQualityTier(quality).FloatDepth;
+        ImGui::Text("Shadow atlas: %dx%d, %zu MB", atlas.Width, atlas.Height,
+                    atlas.NumBytes(floatDepth) >> 20);
+
+        const DynamicResolutionStats& resolution =
+            m_Renderer->GetResolutionStats();
+        ImGui::Text("Resolution scale: %.0f%%, GPU frame: %.2f ms",
+                    resolution.Scale * 100.0f, resolution.GpuMillis);
+    }
+    if (ImGui::CollapsingHeader("Streaming"))
+    {
+        ChunkPrioritizer& prioritizer = m_World->m_ChunkPrioritizer;
+        bool viewAware = prioritizer.IsViewAware();
+        if (ImGui::Checkbox("View aware priority", &viewAware))
+        {
+            prioritizer.SetViewAware(viewAware);
+        }
+
+        const ChunkCoords predicted = m_World->m_PredictedChunk;
+        ImGui::Text("Predicted chunk: (%d, %d, %d)", predicted.X, predicted.Y,
+                    predicted.Z);
+        ImGui::Text("Prefetched chunks: %zu",
+                    m_World->m_PrefetchedChunks.size());
+        ImGui::Text("LOD chunks: %zu", m_World->m_LodManager.NumChunks());
+
+        StreamingScheduler& scheduler = m_World->m_StreamingScheduler;
+        for (int i = 0; i < static_cast<int>(StreamingStage::Count); i++)
+        {
+            const StreamingStage stage = static_cast<StreamingStage>(i);
+            const StreamingStageStats& stats = scheduler.GetStats(stage);
+            const char* name = StreamingStageToStr(stage);
+
+            ImGui::PushID(i);
+            int budget = stats.BudgetMicros;
+            if (ImGui::SliderInt(name, &budget, 0, 16000, "%d us"))
+            {
+                scheduler.SetBudget(stage, budget);
+            }
+            ImGui::Text("Unit cost: %.1f us, batch size: %d",
+                        stats.AvgUnitMicros, stats.BatchSize);
+            ImGui::Text("Last tick: %d units in %.1f us", stats.UnitsLastTick,
+                        stats.MicrosLastTick);
+            ImGui::PopID();
+        }
+    }
     ImGui::End();
 }
 
@@ -3,13 +3,15 @@
 class Window;
 class Camera;
 class World;
+class Renderer;
 
 class UIOverlay
 {
   public:
     UIOverlay() {};
 
-    void Init(Window* window, Camera* camera, World* world);
+    void Init(Window* window, Camera* camera, World* world,
+              Renderer* renderer);
 
     void Shutdown();
 
@@ -23,6 +25,7 @@ class UIOverlay
     Window* m_Window = nullptr;
     Camera* m_Camera = nullptr;
     World* m_World = nullptr;
+    Renderer* m_Renderer = nullptr;
 
     bool m_Enabled = false;
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "ArenaAllocator.h"
 #include "Platform/PlatformMemory.h"
+#include <algorithm>
 #include <cassert>
 #include <stddef.h>
 
@@ -70,14 +71,16 @@ void* ArenaAllocator::AllocBytes(size_t numBytes, size_t align)
 
     assert(offsetNew <= m_Reserved);
 
-    if (offsetNew >= m_Committed)
+    if (offsetNew > m_Committed)
     {
+        // Commit whole pages, but never past the end of the reservation
+        const size_t commitEnd = std::min<size_t>(RoundPageUp(offsetNew),
+                                                  m_Reserved);
         const uintptr_t commitBegin =
             reinterpret_cast<uintptr_t>(m_Base) + m_Committed;
-        const size_t commitSize = RoundPageUp(offsetNew - commitBegin);
         Platform::MemCommitReserved(reinterpret_cast<void*>(commitBegin),
-                                    commitSize);
-        m_Committed += commitSize;
+                                    commitEnd - m_Committed);
+        m_Committed = commitEnd;
     }
     void* const ptr = reinterpret_cast<void*>(
         reinterpret_cast<uintptr_t>(m_Base) + alignedOff);
@@ -100,6 +103,10 @@ void ArenaAllocator::Free()
 {
     if (m_Base != nullptr)
         Platform::MemFree(m_Base, m_Reserved);
+    m_Base = nullptr;
+    m_Offset = 0;
+    m_Committed = 0;
+    m_Reserved = 0;
 }
 
 void ArenaAllocator::Init(size_t committed, size_t reserved)
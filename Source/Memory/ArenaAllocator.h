@@ -28,6 +28,8 @@ class ArenaAllocator
 
     Marker GetMarker() const { return m_Offset; }
 
+    void* GetBase() const { return m_Base; }
+
     void RestoreMarker(Marker marker);
 
     void Clear();
@@ -37,10 +39,10 @@ class ArenaAllocator
     void Init(size_t committed, size_t reserved);
 
   private:
-    void* m_Base;
-    size_t m_Offset;
-    size_t m_Committed;
-    size_t m_Reserved;
+    void* m_Base = nullptr;
+    size_t m_Offset = 0;
+    size_t m_Committed = 0;
+    size_t m_Reserved = 0;
 };
 
 template <typename T>
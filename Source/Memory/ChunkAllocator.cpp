@@ -2,10 +2,12 @@
 #include "../Core/Common.h"
 #include "World/Block.h"
 #include "World/Chunk.h"
+#include "World/ChunkOccupancy.h"
 
 ChunkAllocator::ChunkAllocator(size_t maxChunks)
     : m_ChunkPoolAllocator{sizeof(Chunk), maxChunks},
-      m_BlockDataAllocator{sizeof(BlockType) * CHUNK_VOLUME, maxChunks}
+      m_BlockDataAllocator{sizeof(BlockType) * CHUNK_VOLUME, maxChunks},
+      m_OccupancyAllocator{sizeof(ChunkOccupancy), maxChunks}
 
 {
 }
@@ -14,6 +16,7 @@ void ChunkAllocator::Init(size_t maxChunks)
 {
     m_ChunkPoolAllocator.AllocPool(sizeof(Chunk), maxChunks);
     m_BlockDataAllocator.AllocPool(sizeof(BlockType) * CHUNK_VOLUME, maxChunks);
+    m_OccupancyAllocator.AllocPool(sizeof(ChunkOccupancy), maxChunks);
 }
 
 void* ChunkAllocator::AllocChunk()
@@ -26,6 +29,11 @@ BlockType* ChunkAllocator::AllocBlockData()
     return m_BlockDataAllocator.Alloc<BlockType>();
 }
 
+ChunkOccupancy* ChunkAllocator::AllocOccupancy()
+{
+    return m_OccupancyAllocator.Alloc<ChunkOccupancy>();
+}
+
 void ChunkAllocator::FreeChunk(void* chunk)
 {
     m_ChunkPoolAllocator.DeallocRaw(chunk);
@@ -36,14 +44,21 @@ void ChunkAllocator::FreeBlockData(BlockType* blocks)
     m_BlockDataAllocator.Dealloc(blocks);
 }
 
+void ChunkAllocator::FreeOccupancy(ChunkOccupancy* occupancy)
+{
+    m_OccupancyAllocator.Dealloc(occupancy);
+}
+
 void ChunkAllocator::Reset()
 {
     m_BlockDataAllocator.ResetPool();
+    m_OccupancyAllocator.ResetPool();
     m_ChunkPoolAllocator.ResetPool();
 }
 
 void ChunkAllocator::Free()
 {
     m_BlockDataAllocator.FreePool();
+    m_OccupancyAllocator.FreePool();
     m_ChunkPoolAllocator.FreePool();
 }
@@ -4,6 +4,7 @@
 #include "World/Block.h"
 
 class Chunk;
+class ChunkOccupancy;
 
 class ChunkAllocator
 {
@@ -15,16 +16,21 @@ class ChunkAllocator
 
     void* AllocChunk();
     BlockType* AllocBlockData();
+    ChunkOccupancy* AllocOccupancy();
 
     void FreeChunk(void* chunk);
     void FreeBlockData(BlockType* blocks);
+    void FreeOccupancy(ChunkOccupancy* occupancy);
 
     void Reset();
     void Free();
 
+    size_t GetMaxChunks() const { return m_ChunkPoolAllocator.GetMaxObjects(); }
+
   private:
     PoolAllocator m_ChunkPoolAllocator{};
     PoolAllocator m_BlockDataAllocator{};
+    PoolAllocator m_OccupancyAllocator{};
 };
 
 inline ChunkAllocator g_ChunkAllocator;
@@ -50,6 +50,8 @@ class PoolAllocator
 
     void FreePool();
 
+    size_t GetMaxObjects() const { return m_MaxObjects; }
+
   private:
     void* m_Mem = nullptr;
     PoolNode* m_FreeHead = nullptr;
@@ -0,0 +1,87 @@
+#include "PlatformFile.h"
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+namespace Platform
+{
+const void* MapFileRead(const char* path, size_t& numBytes)
+{
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return nullptr;
+
+    // The view keeps the mapping alive
+    const void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!ptr)
+        return nullptr;
+
+    numBytes = static_cast<size_t>(size.QuadPart);
+    return ptr;
+}
+
+bool UnmapFile(const void* addr, size_t numBytes)
+{
+    return UnmapViewOfFile(addr);
+}
+} // namespace Platform
+
+#elif defined(__APPLE__) || defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Platform
+{
+const void* MapFileRead(const char* path, size_t& numBytes)
+{
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* ptr = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                     MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+        return nullptr;
+
+    numBytes = static_cast<size_t>(info.st_size);
+    return ptr;
+}
+
+bool UnmapFile(const void* addr, size_t numBytes)
+{
+    return munmap(const_cast<void*>(addr), numBytes) == 0;
+}
+} // namespace Platform
+
+#else
+#error "Unsupported OS"
+
+#endif
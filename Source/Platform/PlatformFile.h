@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Platform
+{
+// Maps the whole file read only, nullptr if it doesn't exist, is empty or
+// can't be mapped. The mapping stays valid after the file is closed
+const void* MapFileRead(const char* path, size_t& numBytes);
+
+bool UnmapFile(const void* addr, size_t numBytes);
+} // namespace Platform
@@ -30,6 +30,25 @@ VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
     return *this;
 }
 
+void VertexBuffer::Allocate(size_t size) const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_ID);
+    glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::CopySubData(const VertexBuffer& src, size_t srcOffset,
+                               const VertexBuffer& dst, size_t dstOffset,
+                               size_t size)
+{
+    glBindBuffer(GL_COPY_READ_BUFFER, src.m_ID);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, dst.m_ID);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, srcOffset,
+                        dstOffset, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
 void VertexBuffer::Bind() const
 {
     glBindBuffer(GL_ARRAY_BUFFER, m_ID);
@@ -82,16 +101,14 @@ IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
     return *this;
 }
 
-void IndexBuffer::SetData(const std::vector<uint32_t>& indices) const
+void IndexBuffer::SetData(const std::vector<uint32_t>& indices)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t),
-                 indices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    SetData(indices.data(), indices.size());
 }
 
-void IndexBuffer::SetData(const uint32_t* indices, size_t count) const
+void IndexBuffer::SetData(const uint32_t* indices, size_t count)
 {
+    m_Count = count;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ID);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), indices,
                  GL_STATIC_DRAW);
@@ -27,6 +27,18 @@ class VertexBuffer
     template <typename T>
     void SetData(const T* vertices, size_t count) const;
 
+    // Allocates uninitialized storage, to be filled in with SetSubData()
+    void Allocate(size_t size) const;
+
+    // Offset and count are in elements of T
+    template <typename T>
+    void SetSubData(size_t offset, const T* vertices, size_t count) const;
+
+    // Offsets and size are in bytes
+    static void CopySubData(const VertexBuffer& src, size_t srcOffset,
+                            const VertexBuffer& dst, size_t dstOffset,
+                            size_t size);
+
     void Bind() const;
 
   private:
@@ -69,6 +81,16 @@ inline void VertexBuffer::SetData(const T* vertices, size_t count) const
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+template <typename T>
+inline void VertexBuffer::SetSubData(size_t offset, const T* vertices,
+                                     size_t count) const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_ID);
+    glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(T), count * sizeof(T),
+                    vertices);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 class IndexBuffer
 {
   public:
@@ -84,9 +106,9 @@ class IndexBuffer
     IndexBuffer(IndexBuffer&&) noexcept;
     IndexBuffer& operator=(IndexBuffer&&) noexcept;
 
-    void SetData(const std::vector<uint32_t>& indices) const;
+    void SetData(const std::vector<uint32_t>& indices);
 
-    void SetData(const uint32_t* indices, size_t count) const;
+    void SetData(const uint32_t* indices, size_t count);
 
     void Bind() const;
 
@@ -12,6 +12,19 @@ static float HorizontalToVerticalFov(float horizontalFov, float aspectRatio)
     return 2.0f * glm::atan(glm::tan(horizontalFov / 2.0f) / aspectRatio);
 }
 
+static constexpr float k_NearPlane = 0.1f;
+// Shadow cascades only split the distance the regular chunks are drawn to,
+// the LOD rings past it are drawn unshadowed
+static constexpr float k_ShadowFarPlane =
+    27.8f * (Config::ChunkRenderDistance * 2 + 1);
+static constexpr float k_FarPlane = 27.8f * (Config::ViewDistance * 2 + 1);
+// The horizon starts past every chunk, and its coarsest level reaches half of
+// its grid out from the player, a little more along the diagonal
+static constexpr float k_HorizonNearPlane = 16.0f;
+static constexpr float k_HorizonFarPlane =
+    2.0f * (Config::HorizonSpacing << (Config::HorizonLevels - 1)) *
+    (Config::HorizonGridSize / 2);
+
 enum FrustumCorners
 {
     NEAR_BOTTOM_LEFT = 0,
@@ -40,8 +53,8 @@ Camera::Camera(const PlayerView& playerView)
 
 void Camera::InitMatrices()
 {
-    constexpr float nearPlane = 0.1f;
-    constexpr float farPlane = 27.8f * (Config::ChunkRenderDistance * 2 + 1);
+    constexpr float nearPlane = k_NearPlane;
+    constexpr float farPlane = k_ShadowFarPlane;
 
     constexpr float lambda = 0.8f;
 
@@ -69,7 +82,9 @@ void Camera::InitMatrices()
                              m_SubfrustaPlaneDepths[i + 1]);
     }
 
-    m_Projection = glm::perspective(fov, m_AspectRatio, nearPlane, farPlane);
+    m_Projection = glm::perspective(fov, m_AspectRatio, nearPlane, k_FarPlane);
+    m_HorizonProjection = glm::perspective(
+        fov, m_AspectRatio, k_HorizonNearPlane, k_HorizonFarPlane);
     m_View =
         glm::lookAt(m_Pos, m_Pos + m_Direction, glm::vec3{0.0f, 1.0f, 0.0f});
 }
@@ -97,8 +112,9 @@ void Camera::SetFOVDegreesHorizontal(float degrees)
     const float fov =
         HorizontalToVerticalFov(glm::radians(m_Fov), m_AspectRatio);
     m_Projection =
-        glm::perspective(fov, m_AspectRatio, m_SubfrustaPlaneDepths[0],
-                         m_SubfrustaPlaneDepths[NUM_CASCADES]);
+        glm::perspective(fov, m_AspectRatio, k_NearPlane, k_FarPlane);
+    m_HorizonProjection = glm::perspective(
+        fov, m_AspectRatio, k_HorizonNearPlane, k_HorizonFarPlane);
     for (size_t i = 0; i < NUM_CASCADES; i++)
     {
         m_SubfrustaProjectionMatrices[i] =
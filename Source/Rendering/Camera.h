@@ -26,6 +26,11 @@ class Camera
 
     glm::mat4 GetViewMatrix() const { return m_View; }
     const glm::mat4& GetProjectionMatrix() const { return m_Projection; }
+    // Covers only the horizon's distances, it gets its own depth range
+    const glm::mat4& GetHorizonProjectionMatrix() const
+    {
+        return m_HorizonProjection;
+    }
     const std::array<float, NUM_CASCADES + 1>& GetSubfrustaPlaneDepths() const
     {
         return m_SubfrustaPlaneDepths;
@@ -75,6 +80,7 @@ class Camera
     std::array<float, NUM_CASCADES + 1> m_SubfrustaPlaneDepths;
     std::array<glm::mat4, NUM_CASCADES> m_SubfrustaProjectionMatrices;
     glm::mat4 m_Projection;
+    glm::mat4 m_HorizonProjection;
     glm::mat4 m_View;
 
     WorldCoords m_CurTickPosition{};
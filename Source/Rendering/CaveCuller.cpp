@@ -0,0 +1,143 @@
+#include "CaveCuller.h"
+#include "World/Chunk.h"
+#include "World/ChunkUtils.h"
+#include <algorithm>
+#include <chrono>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static_assert(static_cast<int>(BlockFace::NegZ) ==
+                      (static_cast<int>(BlockFace::PosZ) ^ 1) &&
+                  static_cast<int>(BlockFace::PosX) ==
+                      (static_cast<int>(BlockFace::NegX) ^ 1) &&
+                  static_cast<int>(BlockFace::NegY) ==
+                      (static_cast<int>(BlockFace::PosY) ^ 1),
+              "Opposite faces differ in the lowest bit");
+
+static constexpr uint8_t k_NoFace = static_cast<uint8_t>(BlockFace::Count);
+
+static bool InFrustum(const Chunk& chunk,
+                      const std::array<glm::vec4, 6>& planes)
+{
+    const BlockCoords origin = chunk.GetOrigin();
+    const glm::vec3 min(origin.X, origin.Y, origin.Z);
+    const glm::vec3 max =
+        min + glm::vec3{static_cast<float>(CHUNK_DIMENSION * chunk.GetScale())};
+    for (const glm::vec4& plane : planes)
+    {
+        // The corner farthest along the normal
+        const glm::vec3 corner{plane.x >= 0.0f ? max.x : min.x,
+                               plane.y >= 0.0f ? max.y : min.y,
+                               plane.z >= 0.0f ? max.z : min.z};
+        if (glm::dot(glm::vec3{plane}, corner) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+CaveCuller::CaveCuller() : m_Cells(GRID_SIZE * GRID_SIZE * GRID_SIZE)
+{
+    m_Queue.reserve(m_Cells.size());
+}
+
+int CaveCuller::GridIndex(ChunkCoords coords) const
+{
+    const ChunkCoords offset =
+        coords - m_CameraChunk + ChunkCoords{RADIUS, RADIUS, RADIUS};
+    if (offset.X < 0 || offset.Y < 0 || offset.Z < 0 ||
+        offset.X >= GRID_SIZE || offset.Y >= GRID_SIZE || offset.Z >= GRID_SIZE)
+        return -1;
+    return (offset.Z * GRID_SIZE + offset.Y) * GRID_SIZE + offset.X;
+}
+
+void CaveCuller::Traverse(const Chunk* cameraChunk,
+                          const std::array<Plane, 6>& frustumPlanes)
+{
+    const Clock::time_point start = Clock::now();
+    m_Stats = {};
+    m_HasCameraChunk = cameraChunk != nullptr;
+    if (!m_HasCameraChunk)
+        return;
+
+    m_CameraChunk = cameraChunk->GetCoords();
+    if (++m_Stamp == 0)
+    {
+        std::fill(m_Cells.begin(), m_Cells.end(), Cell{});
+        m_Stamp = 1;
+    }
+
+    std::array<glm::vec4, 6> planes;
+    for (size_t i = 0; i < planes.size(); i++)
+    {
+        const Plane& plane = frustumPlanes[i];
+        planes[i] = glm::vec4{plane.Normal, -glm::dot(plane.Normal, plane.P0)};
+    }
+
+    m_Queue.clear();
+    m_Queue.push_back({cameraChunk, k_NoFace, 0});
+    m_Cells[GridIndex(m_CameraChunk)] = {m_Stamp, 0};
+
+    for (size_t head = 0; head < m_Queue.size(); head++)
+    {
+        const Node node = m_Queue[head];
+        const ChunkVisibility& visibility = node.Target->GetVisibility();
+        for (uint8_t exit = 0; exit < k_NoFace; exit++)
+        {
+            const uint8_t entry = exit ^ 1;
+            if ((node.Directions >> entry) & 1u)
+                continue;
+            if (node.EntryFace != k_NoFace &&
+                !visibility.Connects(static_cast<BlockFace>(node.EntryFace),
+                                     static_cast<BlockFace>(exit)))
+                continue;
+
+            const BlockCoords normal = ChunkUtils::k_FaceNormals[exit];
+            const Chunk* const neighbor =
+                node.Target->GetNeighbor(normal.X, normal.Y, normal.Z);
+            if (!neighbor)
+                continue;
+            const int index = GridIndex(neighbor->GetCoords());
+            if (index < 0)
+                continue;
+            Cell& cell = m_Cells[index];
+            if (cell.Stamp == m_Stamp && ((cell.EntryFaces >> entry) & 1u))
+                continue;
+            if (!InFrustum(*neighbor, planes))
+                continue;
+
+            if (cell.Stamp != m_Stamp)
+                cell = {m_Stamp, 0};
+            cell.EntryFaces |= 1u << entry;
+            m_Queue.push_back(
+                {neighbor, entry,
+                 static_cast<uint8_t>(node.Directions | (1u << exit))});
+        }
+    }
+
+    m_Stats.ChunksVisited = static_cast<int>(m_Queue.size());
+    m_Stats.Micros =
+        std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+}
+
+void CaveCuller::Filter(const std::vector<const Chunk*>& chunks,
+                        std::vector<const Chunk*>& visible)
+{
+    const Clock::time_point start = Clock::now();
+    visible.clear();
+    for (const Chunk* chunk : chunks)
+    {
+        if (!m_HasCameraChunk || chunk->GetLodLevel() > 0)
+        {
+            visible.push_back(chunk);
+            continue;
+        }
+        // Chunks past the grid can't be ruled out
+        const int index = GridIndex(chunk->GetCoords());
+        if (index < 0 || m_Cells[index].Stamp == m_Stamp)
+            visible.push_back(chunk);
+        else
+            m_Stats.ChunksHidden++;
+    }
+    m_Stats.Micros +=
+        std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Camera.h"
+#include "Core/Config.h"
+#include "World/Coordinates.h"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Chunk;
+
+struct CaveCullingStats
+{
+    float Micros = 0.0f;
+    int ChunksVisited = 0;
+    // In the frustum but hidden behind terrain
+    int ChunksHidden = 0;
+};
+
+// Occlusion culling of the regular chunks through their ChunkVisibility. A
+// breadth first search from the camera's chunk crosses into a neighbor only
+// through a face connected to the one it came in through, only in the
+// frustum, and never back toward the camera, so only along directions it
+// hasn't gone the opposite way of yet. Chunks it can't reach are hidden.
+// LOD chunks are left alone
+class CaveCuller
+{
+  public:
+    CaveCuller();
+
+    // Searches from the camera's chunk, nullptr if it isn't loaded, in which
+    // case nothing gets hidden
+    void Traverse(const Chunk* cameraChunk,
+                  const std::array<Plane, 6>& frustumPlanes);
+
+    // The chunks of the list that the last search reached, in the same order
+    void Filter(const std::vector<const Chunk*>& chunks,
+                std::vector<const Chunk*>& visible);
+
+    // Since the last search
+    const CaveCullingStats& GetStats() const { return m_Stats; }
+
+  private:
+    // Regular chunks can be this far from the camera's chunk, on every axis.
+    // The camera can be a chunk past the player's
+    static constexpr int RADIUS = Config::ChunkLoadDistance + 1;
+    static constexpr int GRID_SIZE = 2 * RADIUS + 1;
+
+    struct Node
+    {
+        const Chunk* Target;
+        // BlockFace::Count for the camera's chunk
+        uint8_t EntryFace;
+        // Mask of the BlockFaces stepped through since the camera's chunk
+        uint8_t Directions;
+    };
+
+    struct Cell
+    {
+        // Of the last search that reached the chunk, so that nothing has to
+        // be cleared between searches
+        uint32_t Stamp = 0;
+        // Mask of the faces it was entered through. Each one gets its own
+        // visit, as what can be seen past the chunk depends on it
+        uint8_t EntryFaces = 0;
+    };
+
+    // -1 outside of the grid
+    int GridIndex(ChunkCoords coords) const;
+
+  private:
+    std::vector<Node> m_Queue{};
+    // Around the camera's chunk
+    std::vector<Cell> m_Cells{};
+    uint32_t m_Stamp = 0;
+    ChunkCoords m_CameraChunk{};
+    bool m_HasCameraChunk = false;
+    CaveCullingStats m_Stats{};
+};
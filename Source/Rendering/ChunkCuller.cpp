@@ -0,0 +1,255 @@
+#include "ChunkCuller.h"
+#include "Core/Common.h"
+#include "World/Chunk.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+#ifdef VOXELS_SSE
+#include <xmmintrin.h>
+#endif
+
+static constexpr int k_ClusterShift = 2;
+static_assert((1 << k_ClusterShift) == ChunkCuller::CLUSTER_SIZE);
+
+void ChunkCuller::Bounds::Clear()
+{
+    MinX.clear();
+    MinY.clear();
+    MinZ.clear();
+    MaxX.clear();
+    MaxY.clear();
+    MaxZ.clear();
+}
+
+void ChunkCuller::Bounds::Push(const float* min, const float* max)
+{
+    MinX.push_back(min[0]);
+    MinY.push_back(min[1]);
+    MinZ.push_back(min[2]);
+    MaxX.push_back(max[0]);
+    MaxY.push_back(max[1]);
+    MaxZ.push_back(max[2]);
+}
+
+// So that the last boxes can be loaded four at a time. The padding's results
+// are never read
+void ChunkCuller::Bounds::Pad()
+{
+    constexpr float zero[3]{};
+    for (int i = 0; i < 3; i++)
+        Push(zero, zero);
+}
+
+int ChunkCuller::TestBoxes(const Bounds& bounds, size_t index,
+                           const std::array<glm::vec4, 6>& planes,
+                           int& crossing)
+{
+#ifdef VOXELS_SSE
+    const __m128 minX = _mm_loadu_ps(&bounds.MinX[index]);
+    const __m128 minY = _mm_loadu_ps(&bounds.MinY[index]);
+    const __m128 minZ = _mm_loadu_ps(&bounds.MinZ[index]);
+    const __m128 maxX = _mm_loadu_ps(&bounds.MaxX[index]);
+    const __m128 maxY = _mm_loadu_ps(&bounds.MaxY[index]);
+    const __m128 maxZ = _mm_loadu_ps(&bounds.MaxZ[index]);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 outside = zero;
+    __m128 behind = zero;
+    for (const glm::vec4& plane : planes)
+    {
+        // The corners farthest along and against the normal
+        const __m128 farX = plane.x >= 0.0f ? maxX : minX;
+        const __m128 farY = plane.y >= 0.0f ? maxY : minY;
+        const __m128 farZ = plane.z >= 0.0f ? maxZ : minZ;
+        const __m128 nearX = plane.x >= 0.0f ? minX : maxX;
+        const __m128 nearY = plane.y >= 0.0f ? minY : maxY;
+        const __m128 nearZ = plane.z >= 0.0f ? minZ : maxZ;
+
+        const __m128 x = _mm_set1_ps(plane.x);
+        const __m128 y = _mm_set1_ps(plane.y);
+        const __m128 z = _mm_set1_ps(plane.z);
+        const __m128 w = _mm_set1_ps(plane.w);
+
+        const __m128 farDist = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(x, farX), _mm_mul_ps(y, farY)),
+            _mm_add_ps(_mm_mul_ps(z, farZ), w));
+        const __m128 nearDist = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(x, nearX), _mm_mul_ps(y, nearY)),
+            _mm_add_ps(_mm_mul_ps(z, nearZ), w));
+
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(farDist, zero));
+        behind = _mm_or_ps(behind, _mm_cmplt_ps(nearDist, zero));
+    }
+    crossing = _mm_movemask_ps(behind);
+    return _mm_movemask_ps(outside);
+#else
+    int outside = 0;
+    crossing = 0;
+    for (int lane = 0; lane < 4; lane++)
+    {
+        const size_t i = index + lane;
+        for (const glm::vec4& plane : planes)
+        {
+            const float farDist =
+                plane.x * (plane.x >= 0.0f ? bounds.MaxX[i] : bounds.MinX[i]) +
+                plane.y * (plane.y >= 0.0f ? bounds.MaxY[i] : bounds.MinY[i]) +
+                plane.z * (plane.z >= 0.0f ? bounds.MaxZ[i] : bounds.MinZ[i]) +
+                plane.w;
+            const float nearDist =
+                plane.x * (plane.x >= 0.0f ? bounds.MinX[i] : bounds.MaxX[i]) +
+                plane.y * (plane.y >= 0.0f ? bounds.MinY[i] : bounds.MaxY[i]) +
+                plane.z * (plane.z >= 0.0f ? bounds.MinZ[i] : bounds.MaxZ[i]) +
+                plane.w;
+            if (farDist < 0.0f)
+                outside |= 1 << lane;
+            if (nearDist < 0.0f)
+                crossing |= 1 << lane;
+        }
+    }
+    return outside;
+#endif
+}
+
+const std::vector<const Chunk*>& ChunkCuller::Cull(
+    const std::vector<const Chunk*>& chunks, uint32_t revision,
+    const std::array<Plane, 6>& frustumPlanes)
+{
+    using Clock = std::chrono::high_resolution_clock;
+    const Clock::time_point start = Clock::now();
+    m_Stats = {};
+
+    if (!m_HasClusters || revision != m_Revision ||
+        chunks.size() != m_Visible.size())
+    {
+        BuildClusters(chunks);
+        m_Revision = revision;
+        m_HasClusters = true;
+    }
+
+    std::array<glm::vec4, 6> planes;
+    for (size_t i = 0; i < planes.size(); i++)
+    {
+        const Plane& plane = frustumPlanes[i];
+        planes[i] = glm::vec4{plane.Normal, -glm::dot(plane.Normal, plane.P0)};
+    }
+
+    std::fill(m_Visible.begin(), m_Visible.end(), uint8_t{0});
+    for (size_t first = 0; first < m_Clusters.size(); first += 4)
+    {
+        int crossing;
+        const int outside =
+            TestBoxes(m_ClusterBounds, first, planes, crossing);
+        const size_t count = std::min<size_t>(4, m_Clusters.size() - first);
+        m_Stats.ClustersTested += static_cast<int>(count);
+
+        for (size_t lane = 0; lane < count; lane++)
+        {
+            const Cluster& cluster = m_Clusters[first + lane];
+            const int bit = 1 << lane;
+            if (outside & bit)
+            {
+                m_Stats.ClustersSkipped++;
+                continue;
+            }
+            if (!(crossing & bit))
+            {
+                m_Stats.ClustersSkipped++;
+                for (uint32_t i = cluster.Begin; i < cluster.End; i++)
+                    m_Visible[m_Order[i]] = 1;
+                continue;
+            }
+
+            for (uint32_t i = cluster.Begin; i < cluster.End; i += 4)
+            {
+                int chunksCrossing;
+                const int chunksOutside =
+                    TestBoxes(m_ChunkBounds, i, planes, chunksCrossing);
+                const uint32_t chunkCount = std::min(4u, cluster.End - i);
+                m_Stats.ChunksTested += static_cast<int>(chunkCount);
+                for (uint32_t chunkLane = 0; chunkLane < chunkCount;
+                     chunkLane++)
+                {
+                    if (!(chunksOutside & (1 << chunkLane)))
+                        m_Visible[m_Order[i + chunkLane]] = 1;
+                }
+            }
+        }
+    }
+
+    m_Result.clear();
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        if (m_Visible[i])
+            m_Result.push_back(chunks[i]);
+    }
+
+    m_Stats.ChunksVisible = static_cast<int>(m_Result.size());
+    m_Stats.Micros =
+        std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+    return m_Result;
+}
+
+void ChunkCuller::BuildClusters(const std::vector<const Chunk*>& chunks)
+{
+    // Chunks of the same size sharing a block of CLUSTER_SIZE^3 of them end up
+    // next to each other
+    const auto clusterKey = [&chunks](uint32_t index)
+    {
+        const Chunk& chunk = *chunks[index];
+        const ChunkCoords coords = chunk.GetCoords();
+        return std::tuple{chunk.GetLodLevel(), coords.X >> k_ClusterShift,
+                          coords.Y >> k_ClusterShift,
+                          coords.Z >> k_ClusterShift};
+    };
+
+    m_Order.resize(chunks.size());
+    std::iota(m_Order.begin(), m_Order.end(), 0u);
+    std::sort(m_Order.begin(), m_Order.end(),
+              [&clusterKey](uint32_t a, uint32_t b)
+              { return clusterKey(a) < clusterKey(b); });
+
+    m_ChunkBounds.Clear();
+    m_ClusterBounds.Clear();
+    m_Clusters.clear();
+
+    uint32_t begin = 0;
+    const uint32_t count = static_cast<uint32_t>(m_Order.size());
+    while (begin < count)
+    {
+        const auto key = clusterKey(m_Order[begin]);
+        float clusterMin[3];
+        float clusterMax[3];
+        std::fill_n(clusterMin, 3, std::numeric_limits<float>::max());
+        std::fill_n(clusterMax, 3, std::numeric_limits<float>::lowest());
+
+        uint32_t end = begin;
+        for (; end < count && clusterKey(m_Order[end]) == key; end++)
+        {
+            const Chunk& chunk = *chunks[m_Order[end]];
+            const BlockCoords origin = chunk.GetOrigin();
+            const float size =
+                static_cast<float>(CHUNK_DIMENSION * chunk.GetScale());
+            const float min[3]{static_cast<float>(origin.X),
+                               static_cast<float>(origin.Y),
+                               static_cast<float>(origin.Z)};
+            const float max[3]{min[0] + size, min[1] + size, min[2] + size};
+            m_ChunkBounds.Push(min, max);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                clusterMin[axis] = std::min(clusterMin[axis], min[axis]);
+                clusterMax[axis] = std::max(clusterMax[axis], max[axis]);
+            }
+        }
+
+        m_ClusterBounds.Push(clusterMin, clusterMax);
+        m_Clusters.push_back({begin, end});
+        begin = end;
+    }
+
+    m_ChunkBounds.Pad();
+    m_ClusterBounds.Pad();
+    m_Visible.resize(chunks.size());
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Camera.h"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Chunk;
+
+struct CullingStats
+{
+    float Micros = 0.0f;
+    int ClustersTested = 0;
+    // Clusters entirely outside or entirely inside the frustum, whose chunks
+    // don't get tested on their own
+    int ClustersSkipped = 0;
+    int ChunksTested = 0;
+    int ChunksVisible = 0;
+};
+
+// Frustum culling of a render list. Chunks are grouped into clusters of up to
+// CLUSTER_SIZE^3 chunks of the same size, and the clusters, then the chunks
+// of clusters crossing a plane, get tested four bounding boxes at a time. The
+// clusters only get rebuilt when the list's revision changes, and all storage
+// is kept between frames
+class ChunkCuller
+{
+  public:
+    static constexpr int CLUSTER_SIZE = 4;
+
+    // Visible chunks, in the order of the list, valid until the next call
+    const std::vector<const Chunk*>& Cull(
+        const std::vector<const Chunk*>& chunks, uint32_t revision,
+        const std::array<Plane, 6>& frustumPlanes);
+
+    // Of the last call
+    const CullingStats& GetStats() const { return m_Stats; }
+
+  private:
+    // Structure of arrays, padded to a multiple of four boxes
+    struct Bounds
+    {
+        std::vector<float> MinX{};
+        std::vector<float> MinY{};
+        std::vector<float> MinZ{};
+        std::vector<float> MaxX{};
+        std::vector<float> MaxY{};
+        std::vector<float> MaxZ{};
+
+        void Clear();
+        void Push(const float* min, const float* max);
+        void Pad();
+    };
+
+    struct Cluster
+    {
+        // Range of m_Order
+        uint32_t Begin;
+        uint32_t End;
+    };
+
+    // Bit i of the result is set when box index + i is entirely behind one of
+    // the planes, and of crossing when it's at least partly behind one
+    static int TestBoxes(const Bounds& bounds, size_t index,
+                         const std::array<glm::vec4, 6>& planes,
+                         int& crossing);
+
+    void BuildClusters(const std::vector<const Chunk*>& chunks);
+
+  private:
+    // Indices into the list, grouped by cluster
+    std::vector<uint32_t> m_Order{};
+    Bounds m_ChunkBounds{};
+    Bounds m_ClusterBounds{};
+    std::vector<Cluster> m_Clusters{};
+    // Indexed like the list
+    std::vector<uint8_t> m_Visible{};
+    std::vector<const Chunk*> m_Result{};
+
+    uint32_t m_Revision = 0;
+    bool m_HasClusters = false;
+    CullingStats m_Stats{};
+};
@@ -0,0 +1,186 @@
+#include "ChunkMeshBuffers.h"
+#include "World/ChunkMesh.h"
+#include <utility>
+
+static const BufferLayout& ChunkVertexLayout()
+{
+    static BufferLayout layout{{LayoutElementType::UInt, 1},
+                               {LayoutElementType::UInt, 1}};
+    return layout;
+}
+
+// Spare room given to a range whenever the buffer gets laid out, so that
+// small edits fit without reallocating
+static constexpr uint32_t RangeCapacity(uint32_t count)
+{
+    constexpr uint32_t minSpareFaces = 4;
+    return count + count / 4 + minSpareFaces * ChunkVertex::VERTICES_PER_FACE;
+}
+
+template <size_t N>
+RangedVertexBuffer<N>::RangedVertexBuffer()
+{
+    m_VAO.SetVertexBuffer(m_VBO, ChunkVertexLayout());
+}
+
+template <size_t N>
+void RangedVertexBuffer<N>::Upload(const ChunkVertex* vertices,
+                                   const std::array<uint32_t, N>& counts,
+                                   uint64_t rangeMask)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        if ((rangeMask & (1ull << i)) && counts[i] > m_Capacities[i])
+        {
+            Reallocate(vertices, counts, rangeMask);
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < N; i++)
+    {
+        if (!(rangeMask & (1ull << i)))
+            continue;
+        if (counts[i] > 0)
+            m_VBO.SetSubData(static_cast<size_t>(m_Firsts[i]), vertices,
+                             counts[i]);
+        m_NumVertices = m_NumVertices - m_Counts[i] + counts[i];
+        m_Counts[i] = static_cast<GLsizei>(counts[i]);
+        vertices += counts[i];
+    }
+}
+
+template <size_t N>
+void RangedVertexBuffer<N>::Reallocate(const ChunkVertex* vertices,
+                                       const std::array<uint32_t, N>& counts,
+                                       uint64_t rangeMask)
+{
+    std::array<GLint, N> firsts{};
+    std::array<uint32_t, N> capacities{};
+    size_t totalCapacity = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        const bool replaced = rangeMask & (1ull << i);
+        firsts[i] = static_cast<GLint>(totalCapacity);
+        capacities[i] = RangeCapacity(
+            replaced ? counts[i] : static_cast<uint32_t>(m_Counts[i]));
+        totalCapacity += capacities[i];
+    }
+
+    VertexBuffer newVBO{};
+    newVBO.Allocate(totalCapacity * sizeof(ChunkVertex));
+
+    m_NumVertices = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        if (rangeMask & (1ull << i))
+        {
+            if (counts[i] > 0)
+                newVBO.SetSubData(static_cast<size_t>(firsts[i]), vertices,
+                                  counts[i]);
+            m_Counts[i] = static_cast<GLsizei>(counts[i]);
+            vertices += counts[i];
+        }
+        else if (m_Counts[i] > 0)
+        {
+            VertexBuffer::CopySubData(
+                m_VBO, static_cast<size_t>(m_Firsts[i]) * sizeof(ChunkVertex),
+                newVBO, static_cast<size_t>(firsts[i]) * sizeof(ChunkVertex),
+                static_cast<size_t>(m_Counts[i]) * sizeof(ChunkVertex));
+        }
+        m_NumVertices += static_cast<size_t>(m_Counts[i]);
+    }
+
+    m_VBO = std::move(newVBO);
+    m_VAO.SetVertexBuffer(m_VBO, ChunkVertexLayout());
+    m_Firsts = firsts;
+    m_Capacities = capacities;
+}
+
+template class RangedVertexBuffer<MeshBuilder::NUM_RANGES>;
+template class RangedVertexBuffer<MeshBuilder::NUM_FACES>;
+
+// The members of ChunkMesh that touch its buffers, kept out of the world
+// library so that it builds without GL
+
+void ChunkMesh::Upload()
+{
+    if (!HasPendingUpload())
+        return;
+
+    if (!m_Buffers)
+    {
+        m_Buffers = std::unique_ptr<ChunkMeshBuffers, ChunkMeshBuffersDeleter>{
+            new ChunkMeshBuffers{},
+            {[](ChunkMeshBuffers* buffers) { delete buffers; }}};
+    }
+
+    if (m_HasPendingShadow)
+    {
+        constexpr uint64_t allRanges = (1ull << MeshBuilder::NUM_FACES) - 1;
+        m_Buffers->Shadow.Upload(m_PendingShadow.data(), m_PendingShadowCounts,
+                                 allRanges);
+        m_PendingShadow = {};
+        m_HasPendingShadow = false;
+    }
+
+    const uint64_t ranges =
+        MeshBuilder::RangesForSections(m_PendingSections);
+    m_Buffers->Opaque.Upload(m_PendingOpaque.data(), m_PendingOpaqueCounts,
+                             ranges);
+    m_Buffers->Transparent.Upload(m_PendingTransparent.data(),
+                                  m_PendingTransparentCounts, ranges);
+
+    m_PendingOpaque = {};
+    m_PendingTransparent = {};
+    m_PendingSections = 0;
+
+    // Meshes are only uploaded on the render thread
+    static uint64_t s_UploadStamps = 0;
+    m_UploadStamp = ++s_UploadStamps;
+}
+
+void ChunkMesh::BindOpaque() const
+{
+    m_Buffers->Opaque.Bind();
+}
+
+void ChunkMesh::BindTransparent() const
+{
+    m_Buffers->Transparent.Bind();
+}
+
+void ChunkMesh::BindShadow() const
+{
+    m_Buffers->Shadow.Bind();
+}
+
+size_t ChunkMesh::NumOpaqueVertices() const
+{
+    return m_Buffers ? m_Buffers->Opaque.NumVertices() : 0;
+}
+
+size_t ChunkMesh::NumTransparentVertices() const
+{
+    return m_Buffers ? m_Buffers->Transparent.NumVertices() : 0;
+}
+
+size_t ChunkMesh::NumShadowVertices() const
+{
+    return m_Buffers ? m_Buffers->Shadow.NumVertices() : 0;
+}
+
+const ChunkMesh::SectionBuffer& ChunkMesh::GetOpaque() const
+{
+    return m_Buffers->Opaque;
+}
+
+const ChunkMesh::SectionBuffer& ChunkMesh::GetTransparent() const
+{
+    return m_Buffers->Transparent;
+}
+
+const ChunkMesh::ShadowBuffer& ChunkMesh::GetShadow() const
+{
+    return m_Buffers->Shadow;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Buffer.h"
+#include "VertexArray.h"
+#include "World/ChunkVertex.h"
+#include "World/MeshBuilder.h"
+#include <array>
+#include <cstdint>
+
+// A vertex buffer split into ranges that can each be replaced on their own.
+// Every range has some spare capacity, so that most edits fit in place and get
+// uploaded with glBufferSubData. Only when a range outgrows its capacity is
+// the buffer reallocated, copying the untouched ranges over on the GPU
+template <size_t N>
+class RangedVertexBuffer
+{
+    static_assert(N <= 64, "Range masks are 64 bits");
+
+  public:
+    RangedVertexBuffer();
+
+    // Replaces the ranges set in the mask, taking their vertices one after the
+    // other from vertices. The other ranges keep their contents
+    void Upload(const ChunkVertex* vertices,
+                const std::array<uint32_t, N>& counts, uint64_t rangeMask);
+
+    void Bind() const { m_VAO.Bind(); }
+
+    size_t NumVertices() const { return m_NumVertices; }
+
+    // For glMultiDrawArrays
+    const GLint* GetFirsts() const { return m_Firsts.data(); }
+    const GLsizei* GetCounts() const { return m_Counts.data(); }
+    static constexpr GLsizei NumRanges() { return static_cast<GLsizei>(N); }
+
+  private:
+    void Reallocate(const ChunkVertex* vertices,
+                    const std::array<uint32_t, N>& counts, uint64_t rangeMask);
+
+  private:
+    VertexBuffer m_VBO{};
+    VertexArray m_VAO{};
+    std::array<GLint, N> m_Firsts{};
+    std::array<GLsizei, N> m_Counts{};
+    std::array<uint32_t, N> m_Capacities{};
+    size_t m_NumVertices = 0;
+};
+
+// The buffers of a ChunkMesh, created on its first upload
+struct ChunkMeshBuffers
+{
+    RangedVertexBuffer<MeshBuilder::NUM_RANGES> Opaque{};
+    RangedVertexBuffer<MeshBuilder::NUM_RANGES> Transparent{};
+    // A range per direction
+    RangedVertexBuffer<MeshBuilder::NUM_FACES> Shadow{};
+};
@@ -1,14 +1,114 @@
 #include "ChunkRenderer.h"
 #include <glad/glad.h>
+#include <algorithm>
+#include <array>
+#include <glm/glm.hpp>
 #include <ranges>
 #include "World/Chunk.h"
+#include "World/ChunkUtils.h"
 #include "World/Coordinates.h"
 #include "Camera.h"
 #include "Buffer.h"
+#include "ChunkMeshBuffers.h"
 #include "Core/DebugState.h"
 
 extern DebugState g_DebugState;
 
+// Sections have spare room after their vertices, so draw each range on its own
+// in a single call. Only the ranges of the directions in the face mask
+static void DrawSections(const ChunkMesh::SectionBuffer& buffer,
+                         uint8_t faceMask)
+{
+    if (faceMask == MeshBuilder::ALL_FACES)
+    {
+        glMultiDrawArrays(GL_TRIANGLES, buffer.GetFirsts(), buffer.GetCounts(),
+                          buffer.NumRanges());
+        return;
+    }
+
+    std::array<GLint, MeshBuilder::NUM_RANGES> firsts;
+    std::array<GLsizei, MeshBuilder::NUM_RANGES> counts;
+    GLsizei numRanges = 0;
+    for (size_t face = 0; face < MeshBuilder::NUM_FACES; face++)
+    {
+        if (!(faceMask & (1u << face)))
+            continue;
+        const size_t begin =
+            MeshBuilder::RangeIndex(static_cast<BlockFace>(face), 0);
+        std::copy_n(buffer.GetFirsts() + begin, MeshBuilder::NUM_SECTIONS,
+                    firsts.begin() + numRanges);
+        std::copy_n(buffer.GetCounts() + begin, MeshBuilder::NUM_SECTIONS,
+                    counts.begin() + numRanges);
+        numRanges += static_cast<GLsizei>(MeshBuilder::NUM_SECTIONS);
+    }
+    if (numRanges > 0)
+        glMultiDrawArrays(GL_TRIANGLES, firsts.data(), counts.data(),
+                          numRanges);
+}
+
+// The shadow mesh has a single range per direction
+static void DrawShadowFaces(const ChunkMesh::ShadowBuffer& buffer,
+                            uint8_t faceMask)
+{
+    std::array<GLint, MeshBuilder::NUM_FACES> firsts;
+    std::array<GLsizei, MeshBuilder::NUM_FACES> counts;
+    GLsizei numRanges = 0;
+    for (size_t face = 0; face < MeshBuilder::NUM_FACES; face++)
+    {
+        if (!(faceMask & (1u << face)))
+            continue;
+        firsts[numRanges] = buffer.GetFirsts()[face];
+        counts[numRanges] = buffer.GetCounts()[face];
+        numRanges++;
+    }
+    if (numRanges > 0)
+        glMultiDrawArrays(GL_TRIANGLES, firsts.data(), counts.data(),
+                          numRanges);
+}
+
+// Directions whose faces can be front facing from the point. Faces lie within
+// the chunk's bounds, so a direction only gets rejected once the point is past
+// the chunk on that axis
+static uint8_t FacesTowardPoint(const Chunk& chunk, const glm::vec3& point)
+{
+    const float size = static_cast<float>(CHUNK_DIMENSION * chunk.GetScale());
+    const BlockCoords origin = chunk.GetOrigin();
+    const glm::vec3 min = glm::vec3(origin.X, origin.Y, origin.Z);
+    const glm::vec3 max = min + size;
+
+    uint8_t faceMask = 0;
+    faceMask |= (point.z > min.z) << static_cast<int>(BlockFace::PosZ);
+    faceMask |= (point.z < max.z) << static_cast<int>(BlockFace::NegZ);
+    faceMask |= (point.x < max.x) << static_cast<int>(BlockFace::NegX);
+    faceMask |= (point.x > min.x) << static_cast<int>(BlockFace::PosX);
+    faceMask |= (point.y > min.y) << static_cast<int>(BlockFace::PosY);
+    faceMask |= (point.y < max.y) << static_cast<int>(BlockFace::NegY);
+    return faceMask;
+}
+
+// Directions whose faces are lit by a directional light shining along dir,
+// the same for every chunk
+static uint8_t FacesTowardLight(const glm::vec3& dir)
+{
+    uint8_t faceMask = 0;
+    for (size_t face = 0; face < MeshBuilder::NUM_FACES; face++)
+    {
+        const BlockCoords normal = ChunkUtils::k_FaceNormals[face];
+        const float facing =
+            glm::dot(glm::vec3(normal.X, normal.Y, normal.Z), dir);
+        if (facing < 0.0f)
+            faceMask |= 1u << face;
+    }
+    return faceMask;
+}
+
+static void SetChunkUniforms(const Shader& shader, const Chunk& chunk)
+{
+    const BlockCoords origin = chunk.GetOrigin();
+    shader.SetUniform(Shader::UNIFORM_POSITION, origin.X, origin.Y, origin.Z);
+    shader.SetUniform(Shader::UNIFORM_SCALE, chunk.GetScale());
+}
+
 ChunkRenderer::ChunkRenderer(const UniformBuffer& cameraUBO)
     : m_TextureAtlas{Texture2D::FromPath(ASSETS_PATH
                                          "Textures/VoxelTextures.png")},
@@ -24,8 +124,8 @@ ChunkRenderer::ChunkRenderer(const UniformBuffer& cameraUBO)
     m_WaterShader.BindUniformBlock(cameraUBO.GetBindingPoint(), "Matrices");
 }
 
-void ChunkRenderer::RenderGBuffer(
-    const std::vector<const Chunk*>& chunkList) const
+void ChunkRenderer::RenderGBuffer(const std::vector<const Chunk*>& chunkList,
+                                  const glm::vec3& cameraPos) const
 {
     m_GBufferShader.Bind();
     m_TextureAtlas.Bind();
@@ -36,17 +136,14 @@ void ChunkRenderer::RenderGBuffer(
         if (mesh.NumOpaqueVertices() == 0)
             continue;
         mesh.BindOpaque();
-        const ChunkCoords coords = chunk->GetCoords();
-        m_GBufferShader.SetUniform(
-            Shader::UNIFORM_POSITION, coords.X * CHUNK_DIMENSION,
-            coords.Y * CHUNK_DIMENSION, coords.Z * CHUNK_DIMENSION);
-        glDrawArrays(GL_TRIANGLES, 0,
-                     static_cast<GLsizei>(mesh.NumOpaqueVertices()));
+        SetChunkUniforms(m_GBufferShader, *chunk);
+        DrawSections(mesh.GetOpaque(), FacesTowardPoint(*chunk, cameraPos));
         g_DebugState.DrawCalls++;
     }
 }
 
 void ChunkRenderer::RenderDepth(const std::vector<const Chunk*>& chunkList,
+                                const glm::vec3& lightDir,
                                 size_t cascade) const
 {
     m_DepthShader.Bind();
@@ -55,22 +152,33 @@ void ChunkRenderer::RenderDepth(const std::vector<const Chunk*>& chunkList,
     m_DepthShader.SetUniform(Shader::UNIFORM_CASCADE_INDEX,
                              static_cast<uint32_t>(cascade));
 
+    const uint8_t faceMask = FacesTowardLight(lightDir);
+
     for (const Chunk* chunk : chunkList)
     {
         const ChunkMesh& mesh = chunk->GetMesh();
-        mesh.BindOpaque();
-        const ChunkCoords coords = chunk->GetCoords();
-        m_DepthShader.SetUniform(
-            Shader::UNIFORM_POSITION, coords.X * CHUNK_DIMENSION,
-            coords.Y * CHUNK_DIMENSION, coords.Z * CHUNK_DIMENSION);
-        glDrawArrays(GL_TRIANGLES, 0,
-                     static_cast<GLsizei>(mesh.NumOpaqueVertices()));
+        if constexpr (Config::EnableShadowMeshes)
+        {
+            if (mesh.NumShadowVertices() == 0)
+                continue;
+            mesh.BindShadow();
+            SetChunkUniforms(m_DepthShader, *chunk);
+            DrawShadowFaces(mesh.GetShadow(), faceMask);
+        }
+        else
+        {
+            if (mesh.NumOpaqueVertices() == 0)
+                continue;
+            mesh.BindOpaque();
+            SetChunkUniforms(m_DepthShader, *chunk);
+            DrawSections(mesh.GetOpaque(), faceMask);
+        }
         g_DebugState.DrawCalls++;
     }
 }
 
-void ChunkRenderer::RenderWater(
-    const std::vector<const Chunk*>& chunkList) const
+void ChunkRenderer::RenderWater(const std::vector<const Chunk*>& chunkList,
+                                const glm::vec3& cameraPos) const
 {
     m_WaterShader.Bind();
     m_TextureAtlas.Bind();
@@ -78,13 +186,12 @@ void ChunkRenderer::RenderWater(
     for (const Chunk* chunk : chunkList | std::views::reverse)
     {
         const ChunkMesh& mesh = chunk->GetMesh();
+        if (mesh.NumTransparentVertices() == 0)
+            continue;
         mesh.BindTransparent();
-        const ChunkCoords coords = chunk->GetCoords();
-        m_GBufferShader.SetUniform(
-            Shader::UNIFORM_POSITION, coords.X * CHUNK_DIMENSION,
-            coords.Y * CHUNK_DIMENSION, coords.Z * CHUNK_DIMENSION);
-        glDrawArrays(GL_TRIANGLES, 0,
-                     static_cast<GLsizei>(mesh.NumTransparentVertices()));
+        SetChunkUniforms(m_WaterShader, *chunk);
+        DrawSections(mesh.GetTransparent(),
+                     FacesTowardPoint(*chunk, cameraPos));
         g_DebugState.DrawCalls++;
     }
 }
\ No newline at end of file
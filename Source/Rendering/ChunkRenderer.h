@@ -2,6 +2,7 @@
 
 #include "Texture.h"
 #include "Shader.h"
+#include <glm/vec3.hpp>
 #include <vector>
 
 class Chunk;
@@ -13,10 +14,14 @@ class ChunkRenderer
   public:
     explicit ChunkRenderer(const UniformBuffer& cameraUBO);
 
-    void RenderGBuffer(const std::vector<const Chunk*>& chunkList) const;
+    // Only the face directions of each chunk that can face the camera, or
+    // the light for depth, get drawn
+    void RenderGBuffer(const std::vector<const Chunk*>& chunkList,
+                       const glm::vec3& cameraPos) const;
     void RenderDepth(const std::vector<const Chunk*>& chunkList,
-                     size_t cascade) const;
-    void RenderWater(const std::vector<const Chunk*>& chunkList) const;
+                     const glm::vec3& lightDir, size_t cascade) const;
+    void RenderWater(const std::vector<const Chunk*>& chunkList,
+                     const glm::vec3& cameraPos) const;
 
   private:
     Texture2D m_TextureAtlas;
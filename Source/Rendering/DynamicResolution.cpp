@@ -0,0 +1,102 @@
+#include "DynamicResolution.h"
+#include <glad/glad.h>
+#include "Core/Config.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int k_MaxSteps = static_cast<int>(
+    (1.0f - Config::DynamicResolutionMinScale) / Config::DynamicResolutionStep +
+    0.5f);
+// Weight of each new frame time in the smoothed one
+static constexpr float k_Smoothing = 0.1f;
+
+DynamicResolution::DynamicResolution()
+{
+    glGenQueries(NUM_QUERIES, m_Queries.data());
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    glDeleteQueries(NUM_QUERIES, m_Queries.data());
+}
+
+void DynamicResolution::BeginFrame()
+{
+    ReadQueries();
+
+    // Every query is still waiting on the GPU, so this frame goes untimed
+    m_Timing = m_FramesTimed - m_FramesRead < NUM_QUERIES;
+    if (m_Timing)
+        glBeginQuery(GL_TIME_ELAPSED, m_Queries[m_FramesTimed % NUM_QUERIES]);
+}
+
+void DynamicResolution::EndFrame()
+{
+    if (!m_Timing)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    m_FramesTimed++;
+}
+
+void DynamicResolution::ReadQueries()
+{
+    while (m_FramesRead < m_FramesTimed)
+    {
+        const uint32_t query = m_Queries[m_FramesRead % NUM_QUERIES];
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+        GLuint64 nanos = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanos);
+        m_FramesRead++;
+        AddFrameTime(static_cast<float>(nanos) * 1e-6f);
+    }
+}
+
+void DynamicResolution::AddFrameTime(float millis)
+{
+    // The frames still in flight when the scale changed were drawn at the
+    // old one
+    m_FramesSinceChange++;
+    if (m_FramesSinceChange <= static_cast<int>(NUM_QUERIES))
+        return;
+    if (m_HasTime)
+        m_Stats.GpuMillis += k_Smoothing * (millis - m_Stats.GpuMillis);
+    else
+        m_Stats.GpuMillis = millis;
+    m_HasTime = true;
+
+    if constexpr (!Config::EnableDynamicResolution)
+        return;
+    if (m_FramesSinceChange <
+        static_cast<int>(NUM_QUERIES) + Config::DynamicResolutionSettleFrames)
+        return;
+
+    const float target = Config::DynamicResolutionTargetMs;
+    int steps = m_Steps;
+    if (m_Stats.GpuMillis > target)
+    {
+        // The cost goes with the number of pixels, the square of the scale.
+        // At least a step, as not all of it shrinks with the pixels
+        const float wanted =
+            m_Stats.Scale * std::sqrt(target / m_Stats.GpuMillis);
+        const int wantedSteps = static_cast<int>(
+            std::ceil((1.0f - wanted) / Config::DynamicResolutionStep));
+        steps = std::min(std::max(wantedSteps, m_Steps + 1), k_MaxSteps);
+    }
+    else if (m_Stats.GpuMillis <
+             target * Config::DynamicResolutionHeadroom)
+    {
+        // Back up one step at a time, so that it doesn't overshoot
+        steps = std::max(m_Steps - 1, 0);
+    }
+
+    if (steps != m_Steps)
+    {
+        m_Steps = steps;
+        m_Stats.Scale = 1.0f - m_Steps * Config::DynamicResolutionStep;
+        m_FramesSinceChange = 0;
+        m_HasTime = false;
+    }
+}
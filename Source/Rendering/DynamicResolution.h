@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct DynamicResolutionStats
+{
+    // Smoothed, of the frames the GPU has finished
+    float GpuMillis = 0.0f;
+    // Of the window's width and height
+    float Scale = 1.0f;
+};
+
+// Picks the fraction of the window's resolution the G-buffer and lighting are
+// drawn at, from the time the GPU spends on each frame. The times come from
+// timer queries read back a few frames late, so that waiting on them never
+// stalls the CPU. After each change the scale holds still until frames drawn
+// at it have come back
+class DynamicResolution
+{
+  public:
+    DynamicResolution();
+    ~DynamicResolution();
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Around everything drawn in a frame. The scale only changes in
+    // BeginFrame()
+    void BeginFrame();
+    void EndFrame();
+
+    float GetScale() const { return m_Stats.Scale; }
+    const DynamicResolutionStats& GetStats() const { return m_Stats; }
+
+  private:
+    void ReadQueries();
+
+    void AddFrameTime(float millis);
+
+    static constexpr size_t NUM_QUERIES = 4;
+
+    std::array<uint32_t, NUM_QUERIES> m_Queries{};
+    // Frames timed so far, each with query m_FramesTimed % NUM_QUERIES
+    uint64_t m_FramesTimed = 0;
+    // Of the frames timed, how many have been read back
+    uint64_t m_FramesRead = 0;
+    bool m_Timing = false;
+
+    // Steps of Config::DynamicResolutionStep below full resolution
+    int m_Steps = 0;
+    // Frames read back since the last change
+    int m_FramesSinceChange = 0;
+    bool m_HasTime = false;
+    DynamicResolutionStats m_Stats{};
+};
@@ -9,7 +9,8 @@ static bool IsColorAttachment(FramebufferAttachmentFormat format)
     {
     case FramebufferAttachmentFormat::Depth32F:
     case FramebufferAttachmentFormat::Depth24Stencil8:
-    case FramebufferAttachmentFormat::Depth24: return false;
+    case FramebufferAttachmentFormat::Depth24:
+    case FramebufferAttachmentFormat::Depth16: return false;
     default: return true;
     }
 }
@@ -19,7 +20,8 @@ static GLenum AttachmentFormatToAttachment(FramebufferAttachmentFormat format,
     switch (format)
     {
     case FramebufferAttachmentFormat::Depth32F:
-    case FramebufferAttachmentFormat::Depth24: return GL_DEPTH_ATTACHMENT;
+    case FramebufferAttachmentFormat::Depth24:
+    case FramebufferAttachmentFormat::Depth16: return GL_DEPTH_ATTACHMENT;
     case FramebufferAttachmentFormat::Depth24Stencil8:
         return GL_DEPTH_STENCIL_ATTACHMENT;
     default: return GL_COLOR_ATTACHMENT0 + numColorAttachments;
@@ -61,6 +63,7 @@ static GLenum AttachmentFormatToInternalGL(FramebufferAttachmentFormat format)
     case FramebufferAttachmentFormat::Depth24Stencil8:
         return GL_DEPTH24_STENCIL8;
     case FramebufferAttachmentFormat::Depth24: return GL_DEPTH_COMPONENT24;
+    case FramebufferAttachmentFormat::Depth16: return GL_DEPTH_COMPONENT16;
     default: unreachable();
     }
 }
@@ -77,7 +80,8 @@ static GLenum AttachmentFormatToGL(FramebufferAttachmentFormat format)
     case FramebufferAttachmentFormat::RGBA16F:
     case FramebufferAttachmentFormat::RGBA32F: return GL_RGBA;
     case FramebufferAttachmentFormat::Depth32F:
-    case FramebufferAttachmentFormat::Depth24: return GL_DEPTH_COMPONENT;
+    case FramebufferAttachmentFormat::Depth24:
+    case FramebufferAttachmentFormat::Depth16: return GL_DEPTH_COMPONENT;
     case FramebufferAttachmentFormat::Depth24Stencil8: return GL_DEPTH_STENCIL;
     default: unreachable();
     }
@@ -98,6 +102,7 @@ static GLenum AttachmentFormatToType(FramebufferAttachmentFormat format)
     case FramebufferAttachmentFormat::Depth24Stencil8:
         return GL_UNSIGNED_INT_24_8;
     case FramebufferAttachmentFormat::Depth24: return GL_UNSIGNED_INT;
+    case FramebufferAttachmentFormat::Depth16: return GL_UNSIGNED_SHORT;
     default: unreachable();
     }
 }
@@ -166,6 +171,14 @@ void Framebuffer::SetAttachments(
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void Framebuffer::Resize(int width, int height,
+                         const std::vector<FramebufferAttachment>& attachments)
+{
+    m_Width = width;
+    m_Height = height;
+    SetAttachments(attachments);
+}
+
 Framebuffer::~Framebuffer()
 {
     Destroy();
@@ -14,7 +14,8 @@ enum class FramebufferAttachmentFormat
     RGBA32F,
     Depth32F,
     Depth24Stencil8,
-    Depth24
+    Depth24,
+    Depth16
 };
 
 enum class FramebufferAttachmentType
@@ -46,6 +47,10 @@ class Framebuffer
 
     void SetAttachments(const std::vector<FramebufferAttachment>& attachments);
 
+    // Reallocates the attachments at the new size
+    void Resize(int width, int height,
+                const std::vector<FramebufferAttachment>& attachments);
+
     uint32_t GetTextureAttachment(size_t index) const
     {
         return m_TextureAttachments[index];
@@ -0,0 +1,141 @@
+#include "HorizonRenderer.h"
+#include "Camera.h"
+#include "Core/DebugState.h"
+#include <algorithm>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+extern DebugState g_DebugState;
+
+struct HorizonVertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    std::array<uint8_t, 4> Color;
+};
+
+// Roughly the average color of each block's top texture
+static constexpr std::array<std::array<uint8_t, 4>,
+                            static_cast<size_t>(BlockType::NumBlockTypes)>
+    k_BlockColors{{{0, 0, 0, 0},
+                   {95, 159, 53, 255},
+                   {134, 96, 67, 255},
+                   {125, 125, 125, 255},
+                   {102, 81, 51, 255},
+                   {60, 110, 40, 255},
+                   {219, 207, 163, 255},
+                   {48, 80, 190, 255},
+                   {240, 245, 250, 255}}};
+
+HorizonRenderer::HorizonRenderer(const UniformBuffer& cameraUBO)
+    : m_Shader{ASSETS_PATH "Shaders/Horizon.vert",
+               ASSETS_PATH "Shaders/Horizon.frag"}
+{
+    m_Shader.BindUniformBlock(cameraUBO.GetBindingPoint(), "Matrices");
+
+    const BufferLayout layout{{LayoutElementType::Float, 3},
+                              {LayoutElementType::Float, 3},
+                              {LayoutElementType::UByte, 4}};
+    for (LevelMesh& mesh : m_Levels)
+    {
+        mesh.VAO.SetVertexBuffer(mesh.VBO, layout);
+        mesh.VAO.SetIndexBuffer(mesh.IBO);
+    }
+}
+
+void HorizonRenderer::Upload(const Horizon::Level& level,
+                             LevelMesh& mesh) const
+{
+    constexpr int n = Horizon::NUM_SAMPLES;
+    constexpr int last = Horizon::GRID_SIZE;
+    const float spacing = static_cast<float>(level.Spacing);
+
+    const auto height = [&level](int i, int j) {
+        return static_cast<float>(level.GetSample(i, j).Height);
+    };
+
+    std::vector<HorizonVertex> vertices(n * n);
+    for (int j = 0; j < n; j++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            const Horizon::Sample& sample = level.GetSample(i, j);
+            float y = static_cast<float>(sample.Height);
+
+            // The next coarser level only has the even samples along this
+            // level's outer edge, so the odd ones sit on the line between
+            // them to leave no cracks
+            const bool edgeX = j == 0 || j == last;
+            const bool edgeZ = i == 0 || i == last;
+            if (edgeX && ((level.OriginX + i) & 1))
+                y = (height(i - 1, j) + height(i + 1, j)) * 0.5f;
+            else if (edgeZ && ((level.OriginZ + j) & 1))
+                y = (height(i, j - 1) + height(i, j + 1)) * 0.5f;
+
+            const float dx = height(std::max(i - 1, 0), j) -
+                             height(std::min(i + 1, last), j);
+            const float dz = height(i, std::max(j - 1, 0)) -
+                             height(i, std::min(j + 1, last));
+
+            HorizonVertex& vertex = vertices[j * n + i];
+            vertex.Position = {(level.OriginX + i) * spacing, y,
+                               (level.OriginZ + j) * spacing};
+            vertex.Normal = glm::normalize(glm::vec3{dx, 2.0f * spacing, dz});
+            vertex.Color = k_BlockColors[static_cast<size_t>(sample.Block)];
+        }
+    }
+
+    std::vector<uint32_t> indices{};
+    indices.reserve(Horizon::GRID_SIZE * Horizon::GRID_SIZE * 6);
+    for (int j = 0; j < last; j++)
+    {
+        const int gz = level.OriginZ + j;
+        const bool holeRow = gz >= level.HoleMinZ && gz < level.HoleMaxZ;
+        for (int i = 0; i < last; i++)
+        {
+            const int gx = level.OriginX + i;
+            if (holeRow && gx >= level.HoleMinX && gx < level.HoleMaxX)
+                continue;
+
+            // Counter clockwise seen from above
+            const uint32_t v00 = static_cast<uint32_t>(j * n + i);
+            const uint32_t v10 = v00 + 1;
+            const uint32_t v01 = v00 + n;
+            const uint32_t v11 = v01 + 1;
+            indices.insert(indices.end(), {v00, v01, v11, v00, v11, v10});
+        }
+    }
+
+    mesh.VBO.SetData(vertices);
+    mesh.IBO.SetData(indices);
+    // Uploading unbinds the index buffer from whatever vertex array is bound
+    mesh.VAO.SetIndexBuffer(mesh.IBO);
+    mesh.Revision = level.Revision;
+    mesh.Uploaded = true;
+}
+
+void HorizonRenderer::Render(const Horizon& horizon,
+                             const Camera& camera) const
+{
+    m_Shader.Bind();
+    m_Shader.SetUniform(Shader::UNIFORM_TRANSFORM,
+                        camera.GetHorizonProjectionMatrix());
+
+    for (size_t i = 0; i < m_Levels.size(); i++)
+    {
+        const Horizon::Level& level = horizon.GetLevel(i);
+        LevelMesh& mesh = m_Levels[i];
+        if (level.Revision == 0)
+            continue;
+        if (!mesh.Uploaded || mesh.Revision != level.Revision)
+            Upload(level, mesh);
+        if (mesh.IBO.Count() == 0)
+            continue;
+
+        mesh.VAO.Bind();
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.IBO.Count()),
+                       GL_UNSIGNED_INT, nullptr);
+        g_DebugState.DrawCalls++;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Buffer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "World/Horizon.h"
+#include <array>
+
+class Camera;
+
+class HorizonRenderer
+{
+  public:
+    explicit HorizonRenderer(const UniformBuffer& cameraUBO);
+
+    // One draw per level into the G-buffer, with the horizon's own depth
+    // range. Levels whose samples changed get uploaded first
+    void Render(const Horizon& horizon, const Camera& camera) const;
+
+  private:
+    struct LevelMesh
+    {
+        VertexBuffer VBO{};
+        IndexBuffer IBO{};
+        VertexArray VAO{};
+        uint32_t Revision = 0;
+        bool Uploaded = false;
+    };
+
+    void Upload(const Horizon::Level& level, LevelMesh& mesh) const;
+
+  private:
+    Shader m_Shader;
+    // Filled in lazily by Render()
+    mutable std::array<LevelMesh, Horizon::NUM_LEVELS> m_Levels{};
+};
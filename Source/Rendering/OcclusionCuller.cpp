@@ -0,0 +1,458 @@
+#include "OcclusionCuller.h"
+#include "Core/Common.h"
+#include "World/Chunk.h"
+#include <chrono>
+#include <cmath>
+
+#ifdef VOXELS_SSE
+#include <xmmintrin.h>
+#endif
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Clip space w, the distance in front of the camera, below which a box
+// counts as crossing the near plane
+static constexpr float k_MinW = 0.1f;
+
+// Corner i of a box has the max x if bit 0 is set, max y for bit 1 and max z
+// for bit 2. Each face goes around its quad
+static constexpr std::array<std::array<int, 4>, 6> k_BoxFaces{{{0, 2, 6, 4},
+                                                               {1, 3, 7, 5},
+                                                               {0, 1, 5, 4},
+                                                               {2, 3, 7, 6},
+                                                               {0, 1, 3, 2},
+                                                               {4, 5, 7, 6}}};
+
+OcclusionCuller::OcclusionCuller()
+{
+    for (int level = 0; level < NUM_LEVELS; level++)
+        m_Levels[level].resize((WIDTH >> level) * (HEIGHT >> level));
+    m_Worker = std::thread{&OcclusionCuller::WorkerLoop, this};
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+    {
+        std::lock_guard lock{m_Mutex};
+        m_Quit = true;
+    }
+    m_WorkReady.notify_one();
+    m_Worker.join();
+}
+
+void OcclusionCuller::Begin(const std::vector<const Chunk*>& chunks,
+                            const std::vector<const Chunk*>& waterChunks,
+                            const glm::mat4& viewProjection,
+                            const glm::vec3& cameraPos)
+{
+    m_ViewProjection = viewProjection;
+    m_CameraPos = cameraPos;
+    m_Occluders.clear();
+    m_Boxes.clear();
+    m_NumChunks = chunks.size();
+
+    const auto addBoxes = [this](const std::vector<const Chunk*>& list)
+    {
+        for (const Chunk* chunk : list)
+        {
+            const BlockCoords origin = chunk->GetOrigin();
+            const float scale = static_cast<float>(chunk->GetScale());
+            const glm::vec3 min(origin.X, origin.Y, origin.Z);
+            m_Boxes.push_back(
+                {min, min + glm::vec3{CHUNK_DIMENSION * scale}});
+        }
+    };
+    addBoxes(chunks);
+    addBoxes(waterChunks);
+
+    // Nearest first, they cover the most of the screen
+    for (const Chunk* chunk : chunks)
+    {
+        if (m_Occluders.size() ==
+            static_cast<size_t>(Config::OcclusionMaxOccluders))
+            break;
+        const ChunkOccluder& occluder = chunk->GetOccluder();
+        if (occluder.IsEmpty())
+            continue;
+
+        const BlockCoords origin = chunk->GetOrigin();
+        const float scale = static_cast<float>(chunk->GetScale());
+        const glm::vec3 chunkMin(origin.X, origin.Y, origin.Z);
+        const glm::vec3 min(occluder.Min.X, occluder.Min.Y, occluder.Min.Z);
+        const glm::vec3 max(occluder.Max.X, occluder.Max.Y, occluder.Max.Z);
+        m_Occluders.push_back(
+            {chunkMin + min * scale, chunkMin + max * scale});
+    }
+
+    {
+        std::lock_guard lock{m_Mutex};
+        m_HasWork = true;
+    }
+    m_WorkReady.notify_one();
+}
+
+void OcclusionCuller::End(std::vector<const Chunk*>& chunks,
+                          std::vector<const Chunk*>& waterChunks)
+{
+    const Clock::time_point start = Clock::now();
+    {
+        std::unique_lock lock{m_Mutex};
+        m_WorkDone.wait(lock, [this] { return !m_HasWork; });
+    }
+    const float waitMicros =
+        std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+
+    size_t index = 0;
+    const auto removeHidden = [this, &index](std::vector<const Chunk*>& list)
+    {
+        size_t kept = 0;
+        for (const Chunk* chunk : list)
+        {
+            if (!m_Hidden[index++])
+                list[kept++] = chunk;
+        }
+        const int hidden = static_cast<int>(list.size() - kept);
+        list.resize(kept);
+        return hidden;
+    };
+
+    m_Stats = {.Micros = m_WorkerMicros,
+               .WaitMicros = waitMicros,
+               .Occluders = static_cast<int>(m_Occluders.size()),
+               .ChunksTested = static_cast<int>(m_Boxes.size())};
+    m_Stats.ChunksHidden += removeHidden(chunks);
+    m_Stats.ChunksHidden += removeHidden(waterChunks);
+}
+
+void OcclusionCuller::WorkerLoop()
+{
+    std::unique_lock lock{m_Mutex};
+    while (true)
+    {
+        m_WorkReady.wait(lock, [this] { return m_HasWork || m_Quit; });
+        if (m_Quit)
+            return;
+
+        lock.unlock();
+        Run();
+        lock.lock();
+
+        m_HasWork = false;
+        m_WorkDone.notify_one();
+    }
+}
+
+void OcclusionCuller::Run()
+{
+    const Clock::time_point start = Clock::now();
+
+    std::vector<float>& depth = m_Levels[0];
+    std::fill(depth.begin(), depth.end(), 1.0f);
+    for (const Box& occluder : m_Occluders)
+        RasterizeOccluder(occluder);
+    BuildPyramid();
+
+    m_Hidden.resize(m_Boxes.size());
+    for (size_t i = 0; i < m_Boxes.size(); i++)
+        m_Hidden[i] = IsHidden(m_Boxes[i]);
+
+    m_WorkerMicros =
+        std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+}
+
+bool OcclusionCuller::ProjectBox(const Box& box,
+                                 std::array<glm::vec3, 8>& corners) const
+{
+    for (int i = 0; i < 8; i++)
+    {
+        const glm::vec4 corner{i & 1 ? box.Max.x : box.Min.x,
+                               i & 2 ? box.Max.y : box.Min.y,
+                               i & 4 ? box.Max.z : box.Min.z, 1.0f};
+        const glm::vec4 clip = m_ViewProjection * corner;
+        if (clip.w < k_MinW)
+            return false;
+        corners[i] = {(clip.x / clip.w * 0.5f + 0.5f) * WIDTH,
+                      (clip.y / clip.w * 0.5f + 0.5f) * HEIGHT,
+                      clip.z / clip.w};
+    }
+    return true;
+}
+
+// Counterclockwise, leaving out points along an edge. Returns the number of
+// points
+static int ConvexHull(std::array<glm::vec2, 8> points,
+                      std::array<glm::vec2, 16>& hull)
+{
+    std::sort(points.begin(), points.end(),
+              [](const glm::vec2& a, const glm::vec2& b)
+              { return a.x < b.x || (a.x == b.x && a.y < b.y); });
+    const auto turn = [](const glm::vec2& o, const glm::vec2& a,
+                         const glm::vec2& b)
+    { return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x); };
+
+    // The lower half left to right, then the upper half back
+    int count = 0;
+    for (const glm::vec2& point : points)
+    {
+        while (count >= 2 && turn(hull[count - 2], hull[count - 1], point) <= 0)
+            count--;
+        hull[count++] = point;
+    }
+    const int lower = count + 1;
+    for (int i = static_cast<int>(points.size()) - 2; i >= 0; i--)
+    {
+        while (count >= lower &&
+               turn(hull[count - 2], hull[count - 1], points[i]) <= 0)
+            count--;
+        hull[count++] = points[i];
+    }
+    // The first point is back at the end
+    return count - 1;
+}
+
+void OcclusionCuller::RasterizeOccluder(const Box& box)
+{
+    std::array<glm::vec3, 8> corners;
+    if (!ProjectBox(box, corners))
+        return;
+
+    std::array<glm::vec2, 8> points;
+    for (size_t i = 0; i < corners.size(); i++)
+        points[i] = {corners[i].x, corners[i].y};
+    std::array<glm::vec2, 16> hull;
+    const int numPoints = ConvexHull(points, hull);
+    if (numPoints < 3)
+        return;
+
+    Polygon polygon{};
+    polygon.Min = hull[0];
+    polygon.Max = hull[0];
+    for (int i = 0; i < numPoints; i++)
+    {
+        const glm::vec2& from = hull[i];
+        const glm::vec2& to = hull[(i + 1) % numPoints];
+        const float a = from.y - to.y;
+        const float b = to.x - from.x;
+        // Moved in by half a pixel's extent along the normal, so that only
+        // pixels wholly inside pass with their centers
+        polygon.Edges[polygon.NumEdges++] = {
+            a, b,
+            -(a * from.x + b * from.y) -
+                0.5f * (std::abs(a) + std::abs(b))};
+        polygon.Min = glm::min(polygon.Min, from);
+        polygon.Max = glm::max(polygon.Max, from);
+    }
+
+    // A ray enters the box through the farthest of the planes of the faces
+    // toward the camera. Each plane is moved back to its farthest depth over
+    // the pixel, so that the whole pixel is at least that far
+    const std::array<bool, 6> facesCamera{
+        m_CameraPos.x < box.Min.x, m_CameraPos.x > box.Max.x,
+        m_CameraPos.y < box.Min.y, m_CameraPos.y > box.Max.y,
+        m_CameraPos.z < box.Min.z, m_CameraPos.z > box.Max.z};
+    for (size_t face = 0; face < k_BoxFaces.size(); face++)
+    {
+        if (!facesCamera[face])
+            continue;
+        const std::array<int, 4>& quad = k_BoxFaces[face];
+        const glm::vec3& v0 = corners[quad[0]];
+        const glm::vec3& v1 = corners[quad[1]];
+        const glm::vec3& v2 = corners[quad[2]];
+        const float area =
+            (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        // Edge on, so no ray enters through it
+        if (std::abs(area) < 1e-6f)
+            continue;
+        const float depthX =
+            ((v1.z - v0.z) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.z - v0.z)) /
+            area;
+        const float depthY =
+            ((v1.x - v0.x) * (v2.z - v0.z) - (v1.z - v0.z) * (v2.x - v0.x)) /
+            area;
+        const float depthC = v0.z - depthX * v0.x - depthY * v0.y;
+        polygon.Planes[polygon.NumPlanes++] = {
+            depthX, depthY,
+            depthC + 0.5f * (std::abs(depthX) + std::abs(depthY))};
+    }
+    if (polygon.NumPlanes == 0)
+        return;
+
+    RasterizePolygon(polygon);
+}
+
+// Pixels whose centers pass every edge keep the nearer of their depth and
+// the polygon's
+void OcclusionCuller::RasterizePolygon(const Polygon& polygon)
+{
+    const int minX =
+        std::max(static_cast<int>(std::floor(polygon.Min.x)), 0);
+    const int maxX =
+        std::min(static_cast<int>(std::ceil(polygon.Max.x)), WIDTH - 1);
+    const int minY =
+        std::max(static_cast<int>(std::floor(polygon.Min.y)), 0);
+    const int maxY =
+        std::min(static_cast<int>(std::ceil(polygon.Max.y)), HEIGHT - 1);
+    if (minX > maxX || minY > maxY)
+        return;
+
+    const int numEdges = polygon.NumEdges;
+    const int numPlanes = polygon.NumPlanes;
+    std::vector<float>& depth = m_Levels[0];
+    // Whole groups of four
+    const int startX = minX & ~3;
+
+#ifdef VOXELS_SSE
+    const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+    for (int y = minY; y <= maxY; y++)
+    {
+        const float centerY = static_cast<float>(y) + 0.5f;
+        __m128 rowEdges[8];
+        for (int i = 0; i < numEdges; i++)
+        {
+            const glm::vec3& edge = polygon.Edges[i];
+            rowEdges[i] = _mm_set1_ps(edge.y * centerY + edge.z);
+        }
+        __m128 rowPlanes[3];
+        for (int i = 0; i < numPlanes; i++)
+        {
+            const glm::vec3& plane = polygon.Planes[i];
+            rowPlanes[i] = _mm_set1_ps(plane.y * centerY + plane.z);
+        }
+
+        float* row = depth.data() + y * WIDTH;
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            const __m128 centerX =
+                _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+            __m128 inside = _mm_cmpge_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_set1_ps(polygon.Edges[0].x), centerX),
+                    rowEdges[0]),
+                zero);
+            for (int i = 1; i < numEdges; i++)
+            {
+                inside = _mm_and_ps(
+                    inside,
+                    _mm_cmpge_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(polygon.Edges[i].x),
+                                              centerX),
+                                   rowEdges[i]),
+                        zero));
+            }
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            __m128 pixelDepth = _mm_add_ps(
+                _mm_mul_ps(_mm_set1_ps(polygon.Planes[0].x), centerX),
+                rowPlanes[0]);
+            for (int i = 1; i < numPlanes; i++)
+            {
+                pixelDepth = _mm_max_ps(
+                    pixelDepth,
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(polygon.Planes[i].x),
+                                          centerX),
+                               rowPlanes[i]));
+            }
+            const __m128 old = _mm_loadu_ps(row + x);
+            const __m128 nearer = _mm_min_ps(old, pixelDepth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer),
+                                             _mm_andnot_ps(inside, old)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; y++)
+    {
+        const float centerY = static_cast<float>(y) + 0.5f;
+        float* row = depth.data() + y * WIDTH;
+        for (int x = startX; x <= maxX; x++)
+        {
+            const float centerX = static_cast<float>(x) + 0.5f;
+            bool inside = true;
+            for (int i = 0; i < numEdges; i++)
+            {
+                const glm::vec3& edge = polygon.Edges[i];
+                inside &= edge.x * centerX + edge.y * centerY + edge.z >= 0.0f;
+            }
+            if (!inside)
+                continue;
+
+            float pixelDepth = -1.0f;
+            for (int i = 0; i < numPlanes; i++)
+            {
+                const glm::vec3& plane = polygon.Planes[i];
+                pixelDepth = std::max(pixelDepth, plane.x * centerX +
+                                                      plane.y * centerY +
+                                                      plane.z);
+            }
+            row[x] = std::min(row[x], pixelDepth);
+        }
+    }
+#endif
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+    for (int level = 1; level < NUM_LEVELS; level++)
+    {
+        const std::vector<float>& finer = m_Levels[level - 1];
+        std::vector<float>& coarser = m_Levels[level];
+        const int finerWidth = WIDTH >> (level - 1);
+        const int width = WIDTH >> level;
+        const int height = HEIGHT >> level;
+        for (int y = 0; y < height; y++)
+        {
+            const float* row0 = finer.data() + 2 * y * finerWidth;
+            const float* row1 = row0 + finerWidth;
+            for (int x = 0; x < width; x++)
+            {
+                coarser[y * width + x] =
+                    std::max({row0[2 * x], row0[2 * x + 1], row1[2 * x],
+                              row1[2 * x + 1]});
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsHidden(const Box& box) const
+{
+    std::array<glm::vec3, 8> corners;
+    if (!ProjectBox(box, corners))
+        return false;
+
+    glm::vec3 min = corners[0];
+    glm::vec3 max = corners[0];
+    for (const glm::vec3& corner : corners)
+    {
+        min = glm::min(min, corner);
+        max = glm::max(max, corner);
+    }
+    if (max.x < 0.0f || max.y < 0.0f || min.x >= WIDTH || min.y >= HEIGHT)
+        return false;
+
+    int minX = std::max(static_cast<int>(std::floor(min.x)), 0);
+    int minY = std::max(static_cast<int>(std::floor(min.y)), 0);
+    int maxX = std::min(static_cast<int>(std::floor(max.x)), WIDTH - 1);
+    int maxY = std::min(static_cast<int>(std::floor(max.y)), HEIGHT - 1);
+
+    // The finest level where the box covers at most two texels per axis
+    int level = 0;
+    while (level < NUM_LEVELS - 1 &&
+           ((maxX >> level) - (minX >> level) > 1 ||
+            (maxY >> level) - (minY >> level) > 1))
+        level++;
+    minX >>= level;
+    minY >>= level;
+    maxX >>= level;
+    maxY >>= level;
+
+    const std::vector<float>& depths = m_Levels[level];
+    const int width = WIDTH >> level;
+    float farthest = 0.0f;
+    for (int y = minY; y <= maxY; y++)
+    {
+        for (int x = minX; x <= maxX; x++)
+            farthest = std::max(farthest, depths[y * width + x]);
+    }
+    return min.z > farthest;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Core/Config.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Chunk;
+
+struct OcclusionStats
+{
+    // On the worker, and on the render thread waiting for it
+    float Micros = 0.0f;
+    float WaitMicros = 0.0f;
+    int Occluders = 0;
+    int ChunksTested = 0;
+    int ChunksHidden = 0;
+};
+
+// Occlusion culling against a software depth buffer. Begin() copies the
+// occluder boxes of the nearest chunks and the bounds of every chunk, then a
+// worker thread rasterizes the occluders conservatively, only the pixels they
+// cover whole at no nearer than their depth, builds a pyramid of the farthest
+// depth under each texel and tests each chunk's nearest depth against the
+// texels covering it. End() waits for the worker and removes the hidden
+// chunks. Nothing but the copies reaches the worker, so the world is free to
+// unload chunks in the meantime
+class OcclusionCuller
+{
+  public:
+    static constexpr int WIDTH = Config::OcclusionBufferWidth;
+    static constexpr int HEIGHT = Config::OcclusionBufferHeight;
+    // Down to a single row or column of texels
+    static constexpr int NUM_LEVELS =
+        std::countr_zero(static_cast<unsigned>(std::min(WIDTH, HEIGHT))) + 1;
+
+    static_assert(std::has_single_bit(static_cast<unsigned>(WIDTH)) &&
+                      std::has_single_bit(static_cast<unsigned>(HEIGHT)),
+                  "Every level is half the size of the last");
+    static_assert(WIDTH % 4 == 0, "Rows are rasterized four pixels at a time");
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    // Both lists are sorted front to back, and can't change until End()
+    void Begin(const std::vector<const Chunk*>& chunks,
+               const std::vector<const Chunk*>& waterChunks,
+               const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+
+    // Removes the hidden chunks from the lists given to Begin(), keeping the
+    // order of the rest
+    void End(std::vector<const Chunk*>& chunks,
+             std::vector<const Chunk*>& waterChunks);
+
+    // Of the last End()
+    const OcclusionStats& GetStats() const { return m_Stats; }
+
+  private:
+    struct Box
+    {
+        glm::vec3 Min;
+        glm::vec3 Max;
+    };
+
+    // The outline of a box on screen. Edges and depth planes are each
+    // a * x + b * y + c in pixels, edges positive inside
+    struct Polygon
+    {
+        std::array<glm::vec3, 8> Edges;
+        int NumEdges;
+        std::array<glm::vec3, 3> Planes;
+        int NumPlanes;
+        glm::vec2 Min;
+        glm::vec2 Max;
+    };
+
+    // Corners in pixels, with depth in z. False if any of them is behind
+    // the near plane
+    bool ProjectBox(const Box& box, std::array<glm::vec3, 8>& corners) const;
+
+    void WorkerLoop();
+    void Run();
+    void RasterizeOccluder(const Box& box);
+    void RasterizePolygon(const Polygon& polygon);
+    void BuildPyramid();
+    bool IsHidden(const Box& box) const;
+
+  private:
+    // Worker input
+    glm::mat4 m_ViewProjection{1.0f};
+    glm::vec3 m_CameraPos{};
+    std::vector<Box> m_Occluders{};
+    // The opaque chunks' bounds, then the water chunks'
+    std::vector<Box> m_Boxes{};
+    size_t m_NumChunks = 0;
+
+    // Worker output
+    std::vector<uint8_t> m_Hidden{};
+    float m_WorkerMicros = 0.0f;
+
+    // Level 0 is the depth buffer, in normalized device depth, every further
+    // level half the size of the last with the farthest of the four depths
+    // under each texel
+    std::array<std::vector<float>, NUM_LEVELS> m_Levels{};
+
+    std::thread m_Worker{};
+    std::mutex m_Mutex{};
+    std::condition_variable m_WorkReady{};
+    std::condition_variable m_WorkDone{};
+    bool m_HasWork = false;
+    bool m_Quit = false;
+
+    OcclusionStats m_Stats{};
+};
@@ -4,180 +4,14 @@
 #include "World/World.h"
 #include "Core/Logger.h"
 #include "Math/MathUtils.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <limits>
 #include <random>
 
-using SubfrustumCorners = std::array<glm::vec3, 8>;
-using SubfrustaCorners = std::array<SubfrustumCorners, Camera::NUM_CASCADES>;
-
-template <typename T>
-using SubfrustumArray = std::array<T, Camera::NUM_CASCADES>;
-
 static constexpr glm::mat4 k_Identity{1.0f};
 
-struct AABB
-{
-    glm::vec3 Min;
-    glm::vec3 Max;
-};
-
-static glm::vec3 GetFrustumMidpoint(const SubfrustumCorners& corners)
-{
-    glm::vec3 sum{0.0f};
-    for (const glm::vec3& vec : corners)
-    {
-        sum += vec;
-    }
-    return sum / 8.0f;
-}
-
-static AABB GetLightAABBViewSpace(const SubfrustumCorners& corners,
-                                  const glm::mat4& view, int shadowDimension)
-{
-    AABB aabb{.Min = glm::vec3{std::numeric_limits<float>::max()},
-              .Max = glm::vec3{std::numeric_limits<float>::min()}};
-    for (const glm::vec3& vec : corners)
-    {
-        const glm::vec3 viewVec = view * glm::vec4{vec, 1.0f};
-        aabb.Min = glm::min(aabb.Min, viewVec);
-        aabb.Max = glm::max(aabb.Max, viewVec);
-    }
-
-    aabb.Min.z < 0.0f ? aabb.Min.z *= 10.0f : aabb.Min.z /= 10.0f;
-    aabb.Max.z < 0.0f ? aabb.Max.z /= 10.0f : aabb.Max.z *= 10.0f;
-
-    const glm::vec3 worldUnitsPerTexel =
-        (aabb.Max - aabb.Min) / static_cast<float>(shadowDimension);
-
-    aabb.Min /= worldUnitsPerTexel;
-    aabb.Min = glm::floor(aabb.Min);
-    aabb.Min *= worldUnitsPerTexel;
-
-    aabb.Max /= worldUnitsPerTexel;
-    aabb.Max = glm::floor(aabb.Max);
-    aabb.Max *= worldUnitsPerTexel;
-
-    return aabb;
-}
-
-static AABB GetSubfrustaAABB(const SubfrustumCorners& corners)
-{
-    glm::vec3 min{std::numeric_limits<float>::max()};
-    glm::vec3 max{std::numeric_limits<float>::lowest()};
-
-    for (const glm::vec3& vec : corners)
-    {
-        min = glm::min(min, vec);
-        max = glm::max(max, vec);
-    }
-
-    const float padding = 16.0f;
-    min -= glm::vec3{padding};
-    max += glm::vec3{padding};
-
-    return AABB{min, max};
-}
-
-static AABB GetChunkAABB(ChunkCoords coords)
-{
-    const glm::vec3 min{coords.X * CHUNK_DIMENSION, coords.Y * CHUNK_DIMENSION,
-                        coords.Z * CHUNK_DIMENSION};
-    const glm::vec3 max = min + glm::vec3{static_cast<float>(CHUNK_DIMENSION)};
-    return AABB{min, max};
-}
-
-static bool IsInsidePlane(const glm::vec3& pos, const Plane& plane)
-{
-    return glm::dot(pos - plane.P0, plane.Normal) >= 0.0f;
-}
-
-static bool CheckAABBIntersection(AABB a, AABB b)
-{
-    return a.Min.x <= b.Max.x && a.Max.x >= b.Min.x && a.Min.y <= b.Max.y &&
-           a.Max.y >= b.Min.y && a.Min.z <= b.Max.z && a.Max.z >= b.Min.z;
-}
-
-static bool ChunkInFrustrum(ChunkCoords coords,
-                            const std::array<Plane, 6>& frustumPlanes)
-{
-    constexpr float l = static_cast<float>(CHUNK_DIMENSION);
-    const glm::vec3 chunkWorldPos{coords.X * l, coords.Y * l, coords.Z * l};
-    std::array<glm::vec3, 8> chunkCorners{
-        chunkWorldPos,
-        chunkWorldPos + glm::vec3{l, 0.0f, 0.0f},
-        chunkWorldPos + glm::vec3{0.0f, l, 0.0f},
-        chunkWorldPos + glm::vec3{0.0f, 0.0f, l},
-        chunkWorldPos + glm::vec3{l, l, 0.0f},
-        chunkWorldPos + glm::vec3{0.0f, l, l},
-        chunkWorldPos + glm::vec3{l, 0.0f, l},
-        chunkWorldPos + glm::vec3{l, l, l}};
-
-    for (const Plane& plane : frustumPlanes)
-    {
-        bool allOutside = true;
-        for (const glm::vec3& corner : chunkCorners)
-        {
-            if (IsInsidePlane(corner, plane))
-            {
-                allOutside = false;
-                break;
-            }
-        }
-        if (allOutside)
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
-static bool ChunkInLightView(
-    ChunkCoords coords, const std::array<AABB, Camera::NUM_CASCADES>& aabbs)
-{
-    const AABB chunkAABB = GetChunkAABB(coords);
-    for (const AABB& aabb : aabbs)
-    {
-        if (CheckAABBIntersection(aabb, chunkAABB))
-            return true;
-    }
-    return false;
-}
-
-static std::vector<const Chunk*> GetChunkRenderList(
-    const std::vector<const Chunk*>& renderableChunks, const Camera& camera)
-{
-    std::array<Plane, 6> frustumPlanes;
-    camera.GetFrustumPlanes(frustumPlanes);
-
-    std::vector<const Chunk*> ret{};
-    ret.reserve(renderableChunks.size() / 4);
-    for (const Chunk* chunk : renderableChunks)
-    {
-        if (ChunkInFrustrum(chunk->GetCoords(), frustumPlanes))
-        {
-            ret.push_back(chunk);
-        }
-    }
-    return ret;
-}
-
-static std::vector<const Chunk*> GetPerCascadeChunkRenderList(
-    const std::vector<const Chunk*>& renderableChunks, const AABB& cascadeAABB)
-{
-    std::vector<const Chunk*> ret{};
-    ret.reserve(renderableChunks.size() / 10);
-    for (const Chunk* chunk : renderableChunks)
-    {
-        const AABB chunkAABB = GetChunkAABB(chunk->GetCoords());
-        if (CheckAABBIntersection(chunkAABB, cascadeAABB))
-        {
-            ret.push_back(chunk);
-        }
-    }
-    return ret;
-}
-
 Renderer::Renderer(int windowWidth, int windowHeight)
     : m_WindowWidth{windowWidth}, m_WindowHeight{windowHeight}
 {
@@ -199,24 +33,63 @@ Renderer::Renderer(int windowWidth, int windowHeight)
 
 void Renderer::InitFramebuffers()
 {
-    const FramebufferAttachment depthMapAttachment{
-        .Format = FramebufferAttachmentFormat::Depth32F,
-        .Type = FramebufferAttachmentType::Texture2DArray,
-        .LayerCount = Camera::NUM_CASCADES};
-    m_ShadowFramebuffer.SetAttachments({depthMapAttachment});
+    SetShadowQuality(static_cast<ShadowQuality>(Config::DefaultShadowQuality));
 
-    const FramebufferAttachment positionAttachment{
-        FramebufferAttachmentFormat::RGBA32F};
+    // Normals are octahedral and the albedo's alpha holds the ambient
+    // occlusion. Positions come back from the linear view depth, the depth
+    // buffer has too little precision in the distance for the shadows
     const FramebufferAttachment normalAttachment{
-        FramebufferAttachmentFormat::RGBA16F};
+        FramebufferAttachmentFormat::RG8};
     const FramebufferAttachment albedoAttachment{
-        FramebufferAttachmentFormat::RGBA16F};
+        FramebufferAttachmentFormat::RGBA8};
+    const FramebufferAttachment viewDepthAttachment{
+        FramebufferAttachmentFormat::R32F};
     const FramebufferAttachment depthAttachment{
         FramebufferAttachmentFormat::Depth24,
         FramebufferAttachmentType::Renderbuffer};
 
-    m_DeferredFramebuffer.SetAttachments({positionAttachment, normalAttachment,
-                                          albedoAttachment, depthAttachment});
+    m_DeferredFramebuffer.SetAttachments({normalAttachment, albedoAttachment,
+                                          viewDepthAttachment,
+                                          depthAttachment});
+
+    m_LightingFramebuffer.SetAttachments(
+        {FramebufferAttachment{FramebufferAttachmentFormat::RGBA8}});
+}
+
+void Renderer::SetShadowQuality(ShadowQuality quality)
+{
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+    size_t tier = static_cast<size_t>(quality);
+    ShadowAtlasLayout layout{};
+    while (!PackShadowAtlas(
+        GetShadowQualityTier(static_cast<ShadowQuality>(tier)).Resolutions,
+        maxSize, layout))
+    {
+        if (tier == 0)
+        {
+            LOG_ERROR("No shadow atlas fits in a {} texture", maxSize);
+            return;
+        }
+        tier--;
+    }
+    if (tier != static_cast<size_t>(quality))
+    {
+        LOG_WARN("{} shadows don't fit in a {} texture, using {}",
+                 ShadowQualityToStr(quality), maxSize,
+                 ShadowQualityToStr(static_cast<ShadowQuality>(tier)));
+    }
+
+    m_ShadowQuality = static_cast<ShadowQuality>(tier);
+    m_ShadowAtlas = layout;
+    const ShadowQualityTier& settings = GetShadowQualityTier(m_ShadowQuality);
+    const FramebufferAttachment depthMapAttachment{
+        settings.FloatDepth ? FramebufferAttachmentFormat::Depth32F
+                            : FramebufferAttachmentFormat::Depth16};
+    m_ShadowFramebuffer.Resize(layout.Width, layout.Height,
+                               {depthMapAttachment});
+    m_ShadowCascades.SetResolutions(settings.Resolutions);
 }
 
 void Renderer::InitQuadData()
@@ -235,101 +108,151 @@ void Renderer::InitQuadData()
 
 void Renderer::Render(const World& world, const Camera& camera) const
 {
+    m_DynamicResolution.BeginFrame();
+    const float scale = m_DynamicResolution.GetScale();
+    m_RenderWidth = std::max(
+        static_cast<int>(std::round(m_WindowWidth * scale)), 1);
+    m_RenderHeight = std::max(
+        static_cast<int>(std::round(m_WindowHeight * scale)), 1);
+
     ConfigureMatrices(camera);
 
-    const glm::mat4& view = camera.GetViewMatrix();
     const glm::vec3 lightDir =
         glm::normalize(static_cast<glm::vec3>(world.GetLightDir()));
-    SubfrustumArray<AABB> subfrustaAABBs;
-    SubfrustumArray<glm::mat4> lightViewMatrices;
-
-    for (int i = 0; i < Camera::NUM_CASCADES; i++)
+    m_ShadowCascades.Update(camera, lightDir, world.GetChunkRenderList());
+    for (size_t i = 0; i < Camera::NUM_CASCADES; i++)
     {
-        const glm::mat4& proj = camera.GetSubfrustaProjectionMatrix(i);
-
-        SubfrustumCorners corners;
-        camera.GetSubfrustumCornersWorldSpace(corners, i);
-        const glm::vec3 frustumMidpoint = GetFrustumMidpoint(corners);
-
-        lightViewMatrices[i] =
-            glm::lookAt(frustumMidpoint - lightDir, frustumMidpoint,
-                        glm::vec3{0.0f, 1.0f, 0.0f});
-
-        const AABB lightAABB = GetLightAABBViewSpace(
-            corners, lightViewMatrices[i], m_ShadowFramebuffer.GetWidth());
-        const AABB lightAABBWorld = GetSubfrustaAABB(corners);
-        subfrustaAABBs[i] = lightAABBWorld;
-
-        const glm::mat4 lightProj =
-            glm::ortho(lightAABB.Min.x, lightAABB.Max.x, lightAABB.Min.y,
-                       lightAABB.Max.y, lightAABB.Min.z, lightAABB.Max.z);
-
-        const glm::mat4 lightProjView = lightProj * lightViewMatrices[i];
-
+        const glm::mat4& lightSpace = m_ShadowCascades.GetLightSpaceMatrix(i);
         m_MatrixUBO.SetData((i + 2) * sizeof(glm::mat4), sizeof(glm::mat4),
-                            glm::value_ptr(lightProjView));
+                            glm::value_ptr(lightSpace));
     }
 
     m_MatrixUBO.SetData(0u, sizeof(glm::mat4),
                         glm::value_ptr(camera.GetProjectionMatrix()));
     m_MatrixUBO.SetData(sizeof(glm::mat4), sizeof(glm::mat4),
                         glm::value_ptr(camera.GetViewMatrix()));
+    const glm::mat4 inverseProjection =
+        glm::inverse(camera.GetProjectionMatrix());
+    const glm::mat4 inverseView = glm::inverse(camera.GetViewMatrix());
+    m_MatrixUBO.SetData(6 * sizeof(glm::mat4), sizeof(glm::mat4),
+                        glm::value_ptr(inverseProjection));
+    m_MatrixUBO.SetData(7 * sizeof(glm::mat4), sizeof(glm::mat4),
+                        glm::value_ptr(inverseView));
 
-    std::vector<const Chunk*> chunkRenderList =
-        GetChunkRenderList(world.GetChunkRenderList(), camera);
+    std::array<Plane, 6> frustumPlanes;
+    camera.GetFrustumPlanes(frustumPlanes);
+    const std::vector<const Chunk*>& chunksInFrustum =
+        m_ChunkCuller.Cull(world.GetChunkRenderList(),
+                           world.GetRenderListRevision(), frustumPlanes);
+    const std::vector<const Chunk*>& waterInFrustum =
+        m_WaterCuller.Cull(world.GetChunkWaterRenderList(),
+                           world.GetRenderListRevision(), frustumPlanes);
+    if constexpr (Config::EnableCaveCulling)
+    {
+        const glm::vec3 cameraPos = camera.GetPosition();
+        const ChunkCoords cameraChunk =
+            static_cast<ChunkCoords>(static_cast<BlockCoords>(
+                WorldCoords{cameraPos.x, cameraPos.y, cameraPos.z}));
+        m_CaveCuller.Traverse(world.GetChunk(cameraChunk), frustumPlanes);
+        m_CaveCuller.Filter(chunksInFrustum, m_ChunkRenderList);
+        m_CaveCuller.Filter(waterInFrustum, m_WaterRenderList);
+    }
+    else
+    {
+        m_ChunkRenderList = chunksInFrustum;
+        m_WaterRenderList = waterInFrustum;
+    }
+    // Runs while the shadow maps are drawn
+    if constexpr (Config::EnableOcclusionCulling)
+    {
+        m_OcclusionCuller.Begin(
+            m_ChunkRenderList, m_WaterRenderList,
+            camera.GetProjectionMatrix() * camera.GetViewMatrix(),
+            camera.GetPosition());
+    }
 
+    // Only the cascades that moved or whose chunks changed, the rest keep
+    // what was drawn into them before
     for (size_t i = 0; i < Camera::NUM_CASCADES; i++)
     {
-        const AABB& subfrustaAABB = subfrustaAABBs[i];
-        const std::vector<const Chunk*> perCascadeChunkList =
-            GetPerCascadeChunkRenderList(world.GetChunkRenderList(),
-                                         subfrustaAABB);
-        RenderShadowPass(perCascadeChunkList, i);
+        if (m_ShadowCascades.NeedsDrawing(i))
+            RenderShadowPass(m_ShadowCascades.GetChunks(i), lightDir, i);
     }
 
-    RenderGBufferPass(chunkRenderList);
+    if constexpr (Config::EnableOcclusionCulling)
+        m_OcclusionCuller.End(m_ChunkRenderList, m_WaterRenderList);
+
+    RenderGBufferPass(world, m_ChunkRenderList, camera);
 
     RenderLightingPass(world, camera);
 
-    RenderForwardPass(world, camera);
+    RenderForwardPass(world, m_WaterRenderList, camera);
+
+    m_DynamicResolution.EndFrame();
+}
+
+CullingStats Renderer::GetCullingStats() const
+{
+    const CullingStats& opaque = m_ChunkCuller.GetStats();
+    const CullingStats& water = m_WaterCuller.GetStats();
+    return CullingStats{
+        .Micros = opaque.Micros + water.Micros,
+        .ClustersTested = opaque.ClustersTested + water.ClustersTested,
+        .ClustersSkipped = opaque.ClustersSkipped + water.ClustersSkipped,
+        .ChunksTested = opaque.ChunksTested + water.ChunksTested,
+        .ChunksVisible = opaque.ChunksVisible + water.ChunksVisible};
 }
 
 void Renderer::ConfigureMatrices(const Camera& camera) const {}
 
 void Renderer::RenderShadowPass(const std::vector<const Chunk*>& chunkList,
+                                const glm::vec3& lightDir,
                                 size_t cascade) const
 {
+    // Only the cascade's square of the atlas, the others keep what was drawn
+    // into them
+    const glm::ivec4& rect = m_ShadowAtlas.Cascades[cascade];
     m_ShadowFramebuffer.Bind();
-    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
-                              m_ShadowFramebuffer.GetTextureAttachment(0), 0,
-                              static_cast<GLint>(cascade));
+    glViewport(rect.x, rect.y, rect.z, rect.w);
+    glScissor(rect.x, rect.y, rect.z, rect.w);
+    glEnable(GL_SCISSOR_TEST);
     glClear(GL_DEPTH_BUFFER_BIT);
-    m_ChunkRenderer.RenderDepth(chunkList, cascade);
+    // Casters between the light and the cascade's near plane still land on
+    // it instead of getting clipped
+    glEnable(GL_DEPTH_CLAMP);
+    m_ChunkRenderer.RenderDepth(chunkList, lightDir, cascade);
+    glDisable(GL_DEPTH_CLAMP);
+    glDisable(GL_SCISSOR_TEST);
 }
 
-void Renderer::RenderGBufferPass(
-    const std::vector<const Chunk*>& chunkList) const
+void Renderer::RenderGBufferPass(const World& world,
+                                 const std::vector<const Chunk*>& chunkList,
+                                 const Camera& camera) const
 {
     m_DeferredFramebuffer.Bind();
+    glViewport(0, 0, m_RenderWidth, m_RenderHeight);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    m_ChunkRenderer.RenderGBuffer(chunkList);
+    if constexpr (Config::EnableHorizon)
+    {
+        // Its depth range starts past the chunks, which always cover the
+        // area around the player, so the chunks simply go on top
+        m_HorizonRenderer.Render(world.GetHorizon(), camera);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+    m_ChunkRenderer.RenderGBuffer(chunkList, camera.GetPosition());
 }
 
-// uniform sampler2D u_PositionSampler;
-// uniform sampler2D u_NormalSampler;
-// uniform sampler2D u_AlbedoSampler;
-// uniform sampler2DArray u_ShadowMap;
-
 void Renderer::RenderLightingPass(const World& world,
                                   const Camera& camera) const
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glViewport(0, 0, m_WindowWidth, m_WindowHeight);
+    m_LightingFramebuffer.Bind();
+    glViewport(0, 0, m_RenderWidth, m_RenderHeight);
     glClearColor(0.53f, 0.81f, 0.92f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
     m_DeferredLightingShader.Bind();
+    // Normals, albedo, then depth
     for (size_t i = 0; i < 3; i++)
     {
         glActiveTexture(GL_TEXTURE0 + i);
@@ -337,19 +260,39 @@ void Renderer::RenderLightingPass(const World& world,
                       m_DeferredFramebuffer.GetTextureAttachment(i));
     }
     glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D_ARRAY,
-                  m_ShadowFramebuffer.GetTextureAttachment(0));
+    glBindTexture(GL_TEXTURE_2D, m_ShadowFramebuffer.GetTextureAttachment(0));
 
-    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_POSITION_SAMPLER, 0);
-    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_NORMAL_SAMPLER, 1);
-    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_ALBEDO_SAMPLER, 2);
+    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_NORMAL_SAMPLER, 0);
+    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_ALBEDO_SAMPLER, 1);
+    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_VIEW_DEPTH_SAMPLER, 2);
     m_DeferredLightingShader.SetUniform(Shader::UNIFORM_SHADOW_MAP, 3);
+    // Of the G-buffer's textures that was drawn into
+    m_DeferredLightingShader.SetUniform(
+        Shader::UNIFORM_RESOLUTION_SCALE,
+        glm::vec2{static_cast<float>(m_RenderWidth) / m_WindowWidth,
+                  static_cast<float>(m_RenderHeight) / m_WindowHeight});
+
+    // Normals are in world space
+    const glm::vec3 lightDir =
+        glm::normalize(static_cast<glm::vec3>(world.GetLightDir()));
+    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_LIGHT_DIR, lightDir);
 
-    const glm::vec3 lightDir = static_cast<glm::vec3>(world.GetLightDir());
-    const glm::vec3 lightDirViewSpace =
-        glm::normalize(camera.GetViewMatrix() * glm::vec4{lightDir, 0.0});
-    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_LIGHT_DIR,
-                                        lightDirViewSpace);
+    // Each cascade's square, in texture coordinates of the atlas
+    const float width = static_cast<float>(m_ShadowAtlas.Width);
+    const float height = static_cast<float>(m_ShadowAtlas.Height);
+    std::array<glm::vec4, Camera::NUM_CASCADES> cascadeRects;
+    for (size_t i = 0; i < cascadeRects.size(); i++)
+    {
+        const glm::ivec4& rect = m_ShadowAtlas.Cascades[i];
+        cascadeRects[i] = glm::vec4{rect.x / width, rect.y / height,
+                                    rect.z / width, rect.w / height};
+    }
+    m_DeferredLightingShader.SetUniform(Shader::UNIFORM_CASCADE_RECTS,
+                                        cascadeRects.data(),
+                                        cascadeRects.size());
+    m_DeferredLightingShader.SetUniform(
+        Shader::UNIFORM_PCF_RADIUS,
+        GetShadowQualityTier(m_ShadowQuality).PcfRadius);
 
     const auto& depths = camera.GetSubfrustaPlaneDepths();
 
@@ -361,19 +304,25 @@ void Renderer::RenderLightingPass(const World& world,
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 
-void Renderer::RenderForwardPass(const World& world, const Camera& camera) const
+void Renderer::RenderForwardPass(const World& world,
+                                 const std::vector<const Chunk*>& waterChunks,
+                                 const Camera& camera) const
 {
-    const std::vector<const Chunk*> waterChunks =
-        GetChunkRenderList(world.GetChunkWaterRenderList(), camera);
-
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_DeferredFramebuffer.GetId());
+    // Scaled up to the window, the water and everything after are drawn at
+    // its full resolution
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_LightingFramebuffer.GetId());
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-    glBlitFramebuffer(0, 0, m_WindowWidth, m_WindowHeight, 0, 0, m_WindowWidth,
+    glBlitFramebuffer(0, 0, m_RenderWidth, m_RenderHeight, 0, 0, m_WindowWidth,
+                      m_WindowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_DeferredFramebuffer.GetId());
+    glBlitFramebuffer(0, 0, m_RenderWidth, m_RenderHeight, 0, 0, m_WindowWidth,
                       m_WindowHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, m_WindowWidth, m_WindowHeight);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
 
-    m_ChunkRenderer.RenderWater(waterChunks);
+    m_ChunkRenderer.RenderWater(waterChunks, camera.GetPosition());
 
     m_BlockOutlineRenderer.Render(world, camera);
     glDisable(GL_DEPTH_TEST);
@@ -1,11 +1,18 @@
 #pragma once
 
+#include "CaveCuller.h"
+#include "ChunkCuller.h"
 #include "ChunkRenderer.h"
 #include "Buffer.h"
+#include "DynamicResolution.h"
 #include "Framebuffer.h"
+#include "OcclusionCuller.h"
+#include "ShadowAtlas.h"
+#include "ShadowCascades.h"
 #include <glm/glm.hpp>
 #include "BlockOutlineRenderer.h"
 #include "CrosshairRenderer.h"
+#include "HorizonRenderer.h"
 
 class World;
 class Camera;
@@ -17,6 +24,33 @@ class Renderer
 
     void Render(const World& world, const Camera& camera) const;
 
+    // Of the opaque and water lists together, in the last frame
+    CullingStats GetCullingStats() const;
+    const CaveCullingStats& GetCaveCullingStats() const
+    {
+        return m_CaveCuller.GetStats();
+    }
+    const OcclusionStats& GetOcclusionStats() const
+    {
+        return m_OcclusionCuller.GetStats();
+    }
+    const ShadowStats& GetShadowStats() const
+    {
+        return m_ShadowCascades.GetStats();
+    }
+
+    // Reallocates the shadow atlas. Falls back to lower tiers while the atlas
+    // doesn't fit in a texture
+    void SetShadowQuality(ShadowQuality quality);
+    // The tier in use, which can be lower than the one asked for
+    ShadowQuality GetShadowQuality() const { return m_ShadowQuality; }
+    const ShadowAtlasLayout& GetShadowAtlas() const { return m_ShadowAtlas; }
+
+    const DynamicResolutionStats& GetResolutionStats() const
+    {
+        return m_DynamicResolution.GetStats();
+    }
+
   private:
     void InitFramebuffers();
 
@@ -25,13 +59,17 @@ class Renderer
     void ConfigureMatrices(const Camera& camera) const;
 
     void RenderShadowPass(const std::vector<const Chunk*>& chunks,
-                          size_t cascade) const;
+                          const glm::vec3& lightDir, size_t cascade) const;
 
-    void RenderGBufferPass(const std::vector<const Chunk*>& chunks) const;
+    void RenderGBufferPass(const World& world,
+                           const std::vector<const Chunk*>& chunks,
+                           const Camera& camera) const;
 
     void RenderLightingPass(const World& world, const Camera& camera) const;
 
-    void RenderForwardPass(const World& world, const Camera& camera) const;
+    void RenderForwardPass(const World& world,
+                           const std::vector<const Chunk*>& waterChunks,
+                           const Camera& camera) const;
 
     void DrawFullScreenQuad(uint32_t textureId) const;
 
@@ -39,10 +77,23 @@ class Renderer
     int m_WindowWidth;
     int m_WindowHeight;
 
-    UniformBuffer m_MatrixUBO{7 * sizeof(glm::mat4)};
-
-    Framebuffer m_ShadowFramebuffer{4096, 4096};
+    // Projection, view, the cascades' light space matrices, then the inverse
+    // projection and view
+    UniformBuffer m_MatrixUBO{8 * sizeof(glm::mat4)};
+
+    ShadowQuality m_ShadowQuality = ShadowQuality::Low;
+    ShadowAtlasLayout m_ShadowAtlas{};
+    // Allocated by SetShadowQuality()
+    Framebuffer m_ShadowFramebuffer{0, 0};
+    mutable ShadowCascades m_ShadowCascades{};
+    // Both as large as the window, with only the corner of the scaled size
+    // drawn into
     Framebuffer m_DeferredFramebuffer{m_WindowWidth, m_WindowHeight};
+    Framebuffer m_LightingFramebuffer{m_WindowWidth, m_WindowHeight};
+    mutable DynamicResolution m_DynamicResolution{};
+    // Of this frame's G-buffer and lighting
+    mutable int m_RenderWidth = 0;
+    mutable int m_RenderHeight = 0;
 
     Shader m_QuadShader{ASSETS_PATH "Shaders/Quad.vert",
                         ASSETS_PATH "Shaders/Quad.frag"};
@@ -52,7 +103,16 @@ class Renderer
     VertexBuffer m_QuadVBO{};
     VertexArray m_QuadVAO{};
 
+    mutable ChunkCuller m_ChunkCuller{};
+    mutable ChunkCuller m_WaterCuller{};
+    mutable CaveCuller m_CaveCuller{};
+    mutable OcclusionCuller m_OcclusionCuller{};
+    // What's left of the world's render lists after culling
+    mutable std::vector<const Chunk*> m_ChunkRenderList{};
+    mutable std::vector<const Chunk*> m_WaterRenderList{};
+
     ChunkRenderer m_ChunkRenderer{m_MatrixUBO};
+    HorizonRenderer m_HorizonRenderer{m_MatrixUBO};
     BlockOutlineRenderer m_BlockOutlineRenderer{m_MatrixUBO};
     CrosshairRenderer m_CrosshairRenderer{m_WindowWidth, m_WindowHeight};
 };
\ No newline at end of file
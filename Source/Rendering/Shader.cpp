@@ -161,12 +161,13 @@ int Shader::GetUniformLoc(std::string_view name) const
 void Shader::CacheUniformLocations()
 {
     m_UniformLocations[UNIFORM_POSITION] = GetUniformLoc("u_Position");
+    m_UniformLocations[UNIFORM_SCALE] = GetUniformLoc("u_Scale");
     m_UniformLocations[UNIFORM_TEXTURE_ATLAS] = GetUniformLoc("u_TextureAtlas");
     m_UniformLocations[UNIFORM_SHADOW_MAP] = GetUniformLoc("u_ShadowMap");
     m_UniformLocations[UNIFORM_SUBFRUSTA_PLANES] =
         GetUniformLoc("u_SubfrustaPlanes");
-    m_UniformLocations[UNIFORM_POSITION_SAMPLER] =
-        GetUniformLoc("u_PositionSampler");
+    m_UniformLocations[UNIFORM_VIEW_DEPTH_SAMPLER] =
+        GetUniformLoc("u_ViewDepthSampler");
     m_UniformLocations[UNIFORM_NORMAL_SAMPLER] =
         GetUniformLoc("u_NormalSampler");
     m_UniformLocations[UNIFORM_ALBEDO_SAMPLER] =
@@ -176,4 +177,8 @@ void Shader::CacheUniformLocations()
     m_UniformLocations[UNIFORM_TRANSFORM] = GetUniformLoc("u_Transform");
     m_UniformLocations[UNIFORM_LIGHT_DIR] = GetUniformLoc("u_LightDir");
     m_UniformLocations[UNIFORM_CASCADE_INDEX] = GetUniformLoc("u_CascadeIndex");
+    m_UniformLocations[UNIFORM_CASCADE_RECTS] = GetUniformLoc("u_CascadeRects");
+    m_UniformLocations[UNIFORM_PCF_RADIUS] = GetUniformLoc("u_PcfRadius");
+    m_UniformLocations[UNIFORM_RESOLUTION_SCALE] =
+        GetUniformLoc("u_ResolutionScale");
 }
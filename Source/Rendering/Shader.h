@@ -15,10 +15,11 @@ class Shader
     enum ShaderUniform : uint8_t
     {
         UNIFORM_POSITION,
+        UNIFORM_SCALE,
         UNIFORM_TEXTURE_ATLAS,
         UNIFORM_SHADOW_MAP,
         UNIFORM_SUBFRUSTA_PLANES,
-        UNIFORM_POSITION_SAMPLER,
+        UNIFORM_VIEW_DEPTH_SAMPLER,
         UNIFORM_NORMAL_SAMPLER,
         UNIFORM_ALBEDO_SAMPLER,
         UNIFORM_NOISE_SAMPLER,
@@ -26,6 +27,9 @@ class Shader
         UNIFORM_TRANSFORM,
         UNIFORM_LIGHT_DIR,
         UNIFORM_CASCADE_INDEX,
+        UNIFORM_CASCADE_RECTS,
+        UNIFORM_PCF_RADIUS,
+        UNIFORM_RESOLUTION_SCALE,
         UNIFORM_COUNT
     };
 
@@ -122,6 +126,12 @@ class Shader
         glUniform3fv(m_UniformLocations[uniform], count, glm::value_ptr(vs[0]));
     }
 
+    void SetUniform(ShaderUniform uniform, const glm::vec4* vs,
+                    size_t count) const
+    {
+        glUniform4fv(m_UniformLocations[uniform], count, glm::value_ptr(vs[0]));
+    }
+
   private:
     int GetUniformLoc(std::string_view name) const;
 
@@ -0,0 +1,107 @@
+#include "ShadowAtlas.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+static constexpr size_t k_NumTiers = static_cast<size_t>(ShadowQuality::Count);
+
+// The nearest cascade covers the least ground, so the lower tiers halve the
+// farther ones first, where the loss shows the least
+static constexpr std::array<ShadowQualityTier, k_NumTiers> k_Tiers{{
+    {{1024, 512, 512, 512}, false, 0},
+    {{2048, 1024, 1024, 1024}, false, 1},
+    {{4096, 2048, 2048, 2048}, true, 1},
+    {{4096, 4096, 4096, 4096}, true, 2},
+}};
+
+static const char* s_QualityNames[] = {"Low", "Medium", "High", "Ultra"};
+
+const char* ShadowQualityToStr(ShadowQuality quality)
+{
+    return s_QualityNames[static_cast<size_t>(quality)];
+}
+
+const char** GetAllShadowQualityNames()
+{
+    return s_QualityNames;
+}
+
+const ShadowQualityTier& GetShadowQualityTier(ShadowQuality quality)
+{
+    return k_Tiers[static_cast<size_t>(quality)];
+}
+
+// Fills shelves across the given width, each as tall as its first square.
+// Smaller squares stack into columns as wide as themselves, so that they fill
+// the height of the shelf before taking up more of its width
+static ShadowAtlasLayout PackShelves(
+    const std::array<int, Camera::NUM_CASCADES>& resolutions, int width)
+{
+    ShadowAtlasLayout layout{};
+    layout.Width = width;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    int shelfX = width;
+    int columnX = 0;
+    int columnWidth = 0;
+    int columnY = 0;
+    for (size_t i = 0; i < resolutions.size(); i++)
+    {
+        const int size = resolutions[i];
+        if (size == columnWidth && columnY + size <= shelfHeight)
+        {
+            layout.Cascades[i] = {columnX, shelfY + columnY, size, size};
+            columnY += size;
+            continue;
+        }
+        if (shelfX + size > width)
+        {
+            shelfY += shelfHeight;
+            shelfHeight = size;
+            shelfX = 0;
+        }
+        columnX = shelfX;
+        columnWidth = size;
+        columnY = size;
+        shelfX += size;
+        layout.Cascades[i] = {columnX, shelfY, size, size};
+    }
+    layout.Height = shelfY + shelfHeight;
+    return layout;
+}
+
+bool PackShadowAtlas(const std::array<int, Camera::NUM_CASCADES>& resolutions,
+                     int maxSize, ShadowAtlasLayout& layout)
+{
+    for (size_t i = 0; i < resolutions.size(); i++)
+    {
+        assert(std::has_single_bit(static_cast<unsigned>(resolutions[i])));
+        assert(i == 0 || resolutions[i] <= resolutions[i - 1]);
+    }
+
+    // Every width that is a whole number of the largest squares, keeping the
+    // smallest atlas, the squarer one of two the same size
+    bool found = false;
+    for (size_t columns = 1; columns <= resolutions.size(); columns++)
+    {
+        const int width = static_cast<int>(columns) * resolutions[0];
+        if (width > maxSize)
+            break;
+        const ShadowAtlasLayout candidate = PackShelves(resolutions, width);
+        if (candidate.Height > maxSize)
+            continue;
+
+        const int64_t area = static_cast<int64_t>(candidate.Width) *
+                             candidate.Height;
+        const int64_t bestArea = static_cast<int64_t>(layout.Width) *
+                                 layout.Height;
+        const int side = std::max(candidate.Width, candidate.Height);
+        const int bestSide = std::max(layout.Width, layout.Height);
+        if (!found || area < bestArea || (area == bestArea && side < bestSide))
+        {
+            layout = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
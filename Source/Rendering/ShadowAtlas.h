@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Camera.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+enum class ShadowQuality : uint8_t
+{
+    Low,
+    Medium,
+    High,
+    Ultra,
+    Count
+};
+
+const char* ShadowQualityToStr(ShadowQuality quality);
+const char** GetAllShadowQualityNames();
+
+struct ShadowQualityTier
+{
+    // Of each cascade's square in the atlas, nearest first, powers of two
+    // that never grow from one cascade to the next
+    std::array<int, Camera::NUM_CASCADES> Resolutions;
+    // 32 bit float depth rather than 16 bit normalized
+    bool FloatDepth;
+    // Of the square of texels averaged around each pixel, zero for a single
+    // sample
+    int PcfRadius;
+};
+
+const ShadowQualityTier& GetShadowQualityTier(ShadowQuality quality);
+
+// Where the cascades' shadow maps live in the single depth texture they share
+struct ShadowAtlasLayout
+{
+    int Width = 0;
+    int Height = 0;
+    // Corner and size of each cascade's square, in texels
+    std::array<glm::ivec4, Camera::NUM_CASCADES> Cascades{};
+
+    size_t NumBytes(bool floatDepth) const
+    {
+        return static_cast<size_t>(Width) * Height * (floatDepth ? 4 : 2);
+    }
+};
+
+// Packs the squares of the given resolutions into the smallest atlas it can,
+// at most maxSize texels on each side. False if they don't fit
+bool PackShadowAtlas(const std::array<int, Camera::NUM_CASCADES>& resolutions,
+                     int maxSize, ShadowAtlasLayout& layout);
@@ -0,0 +1,157 @@
+#include "ShadowCascades.h"
+#include "Core/Common.h"
+#include "World/Chunk.h"
+#include <cassert>
+#include <cmath>
+
+void ShadowCascades::SetResolutions(
+    const std::array<int, Camera::NUM_CASCADES>& resolutions)
+{
+    m_Resolutions = resolutions;
+    for (Cascade& cascade : m_Cascades)
+        cascade.HasBeenDrawn = false;
+}
+
+void ShadowCascades::Update(const Camera& camera, const glm::vec3& lightDir,
+                            const std::vector<const Chunk*>& chunks)
+{
+    assert(m_Resolutions[0] > 0 && "Resolutions are set before updating");
+    m_Stats = {};
+    m_Frame++;
+
+    if (lightDir != m_LightDir)
+    {
+        m_LightDir = lightDir;
+        m_LightView = glm::lookAt(glm::vec3{0.0f}, lightDir,
+                                  glm::vec3{0.0f, 1.0f, 0.0f});
+        for (Cascade& cascade : m_Cascades)
+            cascade.HasBeenDrawn = false;
+    }
+
+    for (size_t i = 0; i < m_Cascades.size(); i++)
+    {
+        Cascade& cascade = m_Cascades[i];
+
+        std::array<glm::vec3, 8> corners;
+        camera.GetSubfrustumCornersWorldSpace(corners, i);
+        glm::vec3 center{0.0f};
+        for (const glm::vec3& corner : corners)
+            center += corner;
+        center /= 8.0f;
+        float radius = 0.0f;
+        for (const glm::vec3& corner : corners)
+            radius = std::max(radius, glm::length(corner - center));
+        // Whole blocks, or rounding would change the size every frame
+        radius = std::ceil(radius);
+
+        const float halfExtent = radius * (1.0f + Config::ShadowCascadeSlack);
+        const float slack = halfExtent - radius;
+        const glm::vec3 lightCenter = m_LightView * glm::vec4{center, 1.0f};
+        const glm::vec3 offset = glm::abs(lightCenter - cascade.Center);
+        const bool fits = cascade.HasBeenDrawn &&
+                          cascade.HalfExtent == halfExtent &&
+                          offset.x <= slack && offset.y <= slack &&
+                          offset.z <= slack;
+
+        cascade.Moved = !fits;
+        if (!fits)
+        {
+            // Moving by whole texels keeps the edges of shadows from
+            // crawling
+            const float texel = 2.0f * halfExtent / m_Resolutions[i];
+            cascade.Center = glm::floor(lightCenter / texel) * texel;
+            cascade.HalfExtent = halfExtent;
+
+            const glm::vec3& c = cascade.Center;
+            const glm::mat4 lightProj = glm::ortho(
+                c.x - halfExtent, c.x + halfExtent, c.y - halfExtent,
+                c.y + halfExtent,
+                -(c.z + halfExtent + Config::ShadowCasterDistance),
+                -(c.z - halfExtent));
+            cascade.LightSpace = lightProj * m_LightView;
+        }
+    }
+
+    BinChunks(chunks);
+
+    for (size_t i = 0; i < m_Cascades.size(); i++)
+    {
+        Cascade& cascade = m_Cascades[i];
+        uint64_t key = 0;
+        for (const Chunk* chunk : cascade.Chunks)
+            key += SplitMix64(chunk->GetMesh().GetUploadStamp());
+
+        const bool changed = key != cascade.DrawnKey;
+        cascade.NeedsDrawing = !Config::EnableShadowCaching || cascade.Moved ||
+                               (changed && IsTurnOf(i));
+        if (cascade.NeedsDrawing)
+        {
+            cascade.DrawnKey = key;
+            cascade.HasBeenDrawn = true;
+            m_Stats.CascadesDrawn++;
+            m_Stats.ChunksDrawn += static_cast<int>(cascade.Chunks.size());
+        }
+        else if (changed)
+        {
+            m_Stats.StaleCascades |= static_cast<uint8_t>(1u << i);
+        }
+    }
+}
+
+bool ShadowCascades::IsTurnOf(size_t cascade) const
+{
+    static_assert(Config::ShadowStaggeredCascades <= Camera::NUM_CASCADES);
+    static_assert(Config::ShadowStaggeredCascades <=
+                      Config::ShadowRefreshInterval,
+                  "Each staggered cascade gets a frame of its own");
+    constexpr size_t firstStaggered =
+        Camera::NUM_CASCADES - Config::ShadowStaggeredCascades;
+    if (cascade < firstStaggered)
+        return true;
+    return (m_Frame + cascade - firstStaggered) %
+               Config::ShadowRefreshInterval ==
+           0;
+}
+
+void ShadowCascades::BinChunks(const std::vector<const Chunk*>& chunks)
+{
+    // How far a unit cube's corners reach along each light space axis
+    glm::vec3 reach{0.0f};
+    for (int axis = 0; axis < 3; axis++)
+        reach += glm::abs(glm::vec3{m_LightView[axis]});
+
+    // Each cascade's volume, extruded toward the light without end, as
+    // anything between the light and the cascade can cast into it
+    std::array<glm::vec3, Camera::NUM_CASCADES> mins;
+    std::array<glm::vec2, Camera::NUM_CASCADES> maxs;
+    for (size_t i = 0; i < m_Cascades.size(); i++)
+    {
+        Cascade& cascade = m_Cascades[i];
+        mins[i] = cascade.Center - glm::vec3{cascade.HalfExtent};
+        maxs[i] = glm::vec2{cascade.Center.x + cascade.HalfExtent,
+                            cascade.Center.y + cascade.HalfExtent};
+        cascade.Chunks.clear();
+    }
+
+    for (const Chunk* chunk : chunks)
+    {
+        const BlockCoords origin = chunk->GetOrigin();
+        const float halfSize =
+            0.5f * static_cast<float>(CHUNK_DIMENSION * chunk->GetScale());
+        const glm::vec3 center =
+            glm::vec3(origin.X, origin.Y, origin.Z) + glm::vec3{halfSize};
+        const glm::vec3 lightCenter = m_LightView * glm::vec4{center, 1.0f};
+        const glm::vec3 chunkMin = lightCenter - reach * halfSize;
+        const glm::vec3 chunkMax = lightCenter + reach * halfSize;
+
+        for (size_t i = 0; i < m_Cascades.size(); i++)
+        {
+            if (chunkMin.x <= maxs[i].x && chunkMax.x >= mins[i].x &&
+                chunkMin.y <= maxs[i].y && chunkMax.y >= mins[i].y &&
+                chunkMax.z >= mins[i].z)
+            {
+                m_Cascades[i].Chunks.push_back(chunk);
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Camera.h"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Chunk;
+
+struct ShadowStats
+{
+    // This frame
+    int CascadesDrawn = 0;
+    int ChunksDrawn = 0;
+    // Bit i set when cascade i has remeshed chunks still waiting for its turn
+    uint8_t StaleCascades = 0;
+};
+
+// Fits the shadow cascades to the camera's subfrusta and decides which of them
+// need drawing. A cascade is a square around the bounding sphere of its
+// subfrustum, with some slack, snapped to its texels, so that it stays put
+// while the camera moves around inside of it and its depths stay valid. It
+// gets drawn again only once it has to move, the light turns, or the meshes
+// of the chunks in it change. The farthest cascades take turns picking up
+// mesh changes, as nothing there changes much from one frame to the next
+class ShadowCascades
+{
+  public:
+    // Of each cascade's shadow map, before the first Update(). Every cascade
+    // gets drawn again, as their shadow maps have been reallocated
+    void SetResolutions(
+        const std::array<int, Camera::NUM_CASCADES>& resolutions);
+
+    void Update(const Camera& camera, const glm::vec3& lightDir,
+                const std::vector<const Chunk*>& chunks);
+
+    bool NeedsDrawing(size_t cascade) const
+    {
+        return m_Cascades[cascade].NeedsDrawing;
+    }
+    const glm::mat4& GetLightSpaceMatrix(size_t cascade) const
+    {
+        return m_Cascades[cascade].LightSpace;
+    }
+    // The chunks that can cast shadows into the cascade, from anywhere
+    // toward the light
+    const std::vector<const Chunk*>& GetChunks(size_t cascade) const
+    {
+        return m_Cascades[cascade].Chunks;
+    }
+
+    // Of the last Update()
+    const ShadowStats& GetStats() const { return m_Stats; }
+
+  private:
+    struct Cascade
+    {
+        // In light space, of the last time the cascade was drawn
+        glm::vec3 Center{};
+        float HalfExtent = 0.0f;
+        glm::mat4 LightSpace{1.0f};
+        // Of the upload stamps of the meshes the cascade was drawn with
+        uint64_t DrawnKey = 0;
+        bool HasBeenDrawn = false;
+        // Refitted this frame
+        bool Moved = false;
+        bool NeedsDrawing = false;
+        std::vector<const Chunk*> Chunks{};
+    };
+
+    // Mesh changes only get picked up on its turn, for the staggered ones
+    bool IsTurnOf(size_t cascade) const;
+
+    // Sorts the chunks into the cascades they can cast shadows into, in a
+    // single pass over them
+    void BinChunks(const std::vector<const Chunk*>& chunks);
+
+  private:
+    std::array<int, Camera::NUM_CASCADES> m_Resolutions{};
+    // Rotates world space into light space, looking along the light
+    glm::mat4 m_LightView{1.0f};
+    glm::vec3 m_LightDir{};
+    uint64_t m_Frame = 0;
+    std::array<Cascade, Camera::NUM_CASCADES> m_Cascades{};
+    ShadowStats m_Stats{};
+};
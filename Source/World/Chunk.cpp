@@ -1,28 +1,96 @@
 #include "Chunk.h"
 #include "ChunkUtils.h"
+#include "Core/Common.h"
+#include "Core/Config.h"
+#include "MeshCache.h"
 #include "Memory/ChunkAllocator.h"
+#include <algorithm>
+#include <bit>
 #include <cassert>
 
+static constexpr size_t k_NumFaces = static_cast<size_t>(BlockFace::Count);
+
+// Order dependent, unlike the XOR of block hashes
+static uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+    return SplitMix64(seed ^ SplitMix64(value));
+}
+
+// splitmix64 finalizer over the block's index and type. Air is zero so that
+// writing air over air, or loading an empty chunk, leaves hashes untouched
+static uint64_t BlockHash(size_t i, BlockType blockType)
+{
+    if (blockType == BlockType::Air)
+        return 0;
+
+    return SplitMix64((static_cast<uint64_t>(i) << 8) |
+                      static_cast<uint64_t>(blockType));
+}
+
+// Mask of the border slabs a block lies in, indexed by BlockFace
+static uint8_t BorderFaces(size_t i)
+{
+    constexpr uint8_t last = CHUNK_DIMENSION - 1;
+    const uint8_t x = ChunkUtils::ExtractX(i);
+    const uint8_t y = ChunkUtils::ExtractY(i);
+    const uint8_t z = ChunkUtils::ExtractZ(i);
+
+    uint8_t mask = 0;
+    mask |= (z == last) << static_cast<int>(BlockFace::PosZ);
+    mask |= (z == 0) << static_cast<int>(BlockFace::NegZ);
+    mask |= (x == 0) << static_cast<int>(BlockFace::NegX);
+    mask |= (x == last) << static_cast<int>(BlockFace::PosX);
+    mask |= (y == last) << static_cast<int>(BlockFace::PosY);
+    mask |= (y == 0) << static_cast<int>(BlockFace::NegY);
+    return mask;
+}
+
+// BlockFace values come in opposite pairs
+static BlockFace OppositeFace(BlockFace face)
+{
+    return static_cast<BlockFace>(static_cast<uint8_t>(face) ^ 1);
+}
+
 Chunk::Chunk() : Chunk{ChunkCoords{}} {}
 
-Chunk::Chunk(ChunkCoords coords) : m_Coords{coords}
+Chunk::Chunk(ChunkCoords coords, uint8_t lodLevel)
+    : m_Coords{coords}, m_LodLevel{lodLevel}
 {
     m_Blocks = g_ChunkAllocator.AllocBlockData();
+    // Pool memory is uninitialized, and the hashes assume an empty chunk
+    std::fill_n(m_Blocks, CHUNK_VOLUME, BlockType::Air);
+    m_Occupancy = g_ChunkAllocator.AllocOccupancy();
+    m_Occupancy->Clear();
+    m_Neighbors[ChunkUtils::k_CenterNeighborSlot] = this;
 }
 
 Chunk::~Chunk()
 {
+    UnlinkNeighbors();
     if (m_Blocks)
         g_ChunkAllocator.FreeBlockData(m_Blocks);
+    if (m_Occupancy)
+        g_ChunkAllocator.FreeOccupancy(m_Occupancy);
     m_Blocks = nullptr;
+    m_Occupancy = nullptr;
 }
 
 Chunk::Chunk(Chunk&& other)
-    : m_Blocks{other.m_Blocks}, m_Coords{other.m_Coords},
-      m_Mesh{std::move(other.m_Mesh)}, m_NeedsRebuild{other.m_NeedsRebuild},
+    : m_Blocks{other.m_Blocks}, m_Occupancy{other.m_Occupancy},
+      m_Coords{other.m_Coords}, m_LodLevel{other.m_LodLevel},
+      m_Mesh{std::move(other.m_Mesh)}, m_Visibility{other.m_Visibility},
+      m_Occluder{other.m_Occluder}, m_ContentHash{other.m_ContentHash},
+      m_BorderHashes{other.m_BorderHashes},
+      m_MeshedContentHash{other.m_MeshedContentHash},
+      m_MeshedNeighborBorders{other.m_MeshedNeighborBorders},
+      m_HasMeshedHashes{other.m_HasMeshedHashes},
+      m_TriedMeshCache{other.m_TriedMeshCache},
+      m_DirtySections{other.m_DirtySections},
       m_PotentiallyHasBlocks{other.m_PotentiallyHasBlocks}
 {
     other.m_Blocks = nullptr;
+    other.m_Occupancy = nullptr;
+    TakeNeighbors(other);
 }
 
 Chunk& Chunk::operator=(Chunk&& other)
@@ -32,14 +100,30 @@ Chunk& Chunk::operator=(Chunk&& other)
 
     if (m_Blocks)
         g_ChunkAllocator.FreeBlockData(m_Blocks);
+    if (m_Occupancy)
+        g_ChunkAllocator.FreeOccupancy(m_Occupancy);
 
     m_Blocks = other.m_Blocks;
+    m_Occupancy = other.m_Occupancy;
     m_Coords = other.m_Coords;
+    m_LodLevel = other.m_LodLevel;
     m_Mesh = std::move(other.m_Mesh);
-    m_NeedsRebuild = other.m_NeedsRebuild;
+    m_Visibility = other.m_Visibility;
+    m_Occluder = other.m_Occluder;
+    m_ContentHash = other.m_ContentHash;
+    m_BorderHashes = other.m_BorderHashes;
+    m_MeshedContentHash = other.m_MeshedContentHash;
+    m_MeshedNeighborBorders = other.m_MeshedNeighborBorders;
+    m_HasMeshedHashes = other.m_HasMeshedHashes;
+    m_TriedMeshCache = other.m_TriedMeshCache;
+    m_DirtySections = other.m_DirtySections;
     m_PotentiallyHasBlocks = other.m_PotentiallyHasBlocks;
 
     other.m_Blocks = nullptr;
+    other.m_Occupancy = nullptr;
+
+    UnlinkNeighbors();
+    TakeNeighbors(other);
 
     return *this;
 }
@@ -68,24 +152,275 @@ BlockType Chunk::GetBlock(uint8_t x, uint8_t y, uint8_t z) const
     return m_Blocks[ChunkUtils::PackXYZ(x, y, z)];
 }
 
-void Chunk::SetBlock(BlockType blockType, size_t i)
+bool Chunk::WriteBlock(BlockType blockType, size_t i)
 {
-    m_NeedsRebuild = true;
+    const BlockType oldBlock = m_Blocks[i];
+    if (oldBlock == blockType)
+        return false;
+
+    const uint64_t delta = BlockHash(i, oldBlock) ^ BlockHash(i, blockType);
+    m_ContentHash ^= delta;
+    for (uint8_t faces = BorderFaces(i); faces != 0; faces &= faces - 1)
+        m_BorderHashes[std::countr_zero(faces)] ^= delta;
+
+    m_Occupancy->Update(ChunkUtils::ExtractLocalBlockCoords(i),
+                        ChunkOccupancy::GetClasses(oldBlock),
+                        ChunkOccupancy::GetClasses(blockType));
+
     if (blockType != BlockType::Air)
         m_PotentiallyHasBlocks = true;
     m_Blocks[i] = blockType;
+    return true;
+}
+
+void Chunk::SetBlock(BlockType blockType, size_t i)
+{
+    if (!WriteBlock(blockType, i))
+        return;
+
+    const int y = ChunkUtils::ExtractY(i);
+    m_DirtySections |= MeshBuilder::SectionsForRows(y, y);
 }
 
 void Chunk::SetBlock(BlockType blockType, uint8_t x, uint8_t y, uint8_t z)
 {
-    m_NeedsRebuild = true;
-    if (blockType != BlockType::Air)
+    if (WriteBlock(blockType, ChunkUtils::PackXYZ(x, y, z)))
+        m_DirtySections |= MeshBuilder::SectionsForRows(y, y);
+}
+
+void Chunk::FillBlocks(BlockType blockType, LocalBlockCoords min,
+                       LocalBlockCoords max)
+{
+    assert(min.X <= max.X && min.Y <= max.Y && min.Z <= max.Z);
+
+    constexpr uint8_t last = CHUNK_DIMENSION - 1;
+    const auto borderHash = [this](BlockFace face) -> uint64_t& {
+        return m_BorderHashes[static_cast<size_t>(face)];
+    };
+    const uint8_t classes = ChunkOccupancy::GetClasses(blockType);
+    const size_t rowLength = static_cast<size_t>(max.X - min.X + 1);
+    bool changed = false;
+    for (uint8_t y = min.Y; y <= max.Y; y++)
+    {
+        bool layerChanged = false;
+        for (uint8_t z = min.Z; z <= max.Z; z++)
+        {
+            const size_t rowStart = ChunkUtils::PackXYZ(min.X, y, z);
+            BlockType* const row = m_Blocks + rowStart;
+
+            // Hashes only change by the blocks that do, the X borders only
+            // by the ends of the row
+            bool rowChanged = false;
+            uint64_t rowDelta = 0;
+            uint64_t firstDelta = 0;
+            uint64_t lastDelta = 0;
+            for (size_t x = 0; x < rowLength; x++)
+            {
+                if (row[x] == blockType)
+                    continue;
+                const uint64_t delta = BlockHash(rowStart + x, row[x]) ^
+                                       BlockHash(rowStart + x, blockType);
+                rowDelta ^= delta;
+                if (x == 0)
+                    firstDelta = delta;
+                if (x == rowLength - 1)
+                    lastDelta = delta;
+                rowChanged = true;
+            }
+            if (!rowChanged)
+                continue;
+
+            m_ContentHash ^= rowDelta;
+            if (y == 0)
+                borderHash(BlockFace::NegY) ^= rowDelta;
+            if (y == last)
+                borderHash(BlockFace::PosY) ^= rowDelta;
+            if (z == 0)
+                borderHash(BlockFace::NegZ) ^= rowDelta;
+            if (z == last)
+                borderHash(BlockFace::PosZ) ^= rowDelta;
+            if (min.X == 0)
+                borderHash(BlockFace::NegX) ^= firstDelta;
+            if (max.X == last)
+                borderHash(BlockFace::PosX) ^= lastDelta;
+
+            m_Occupancy->FillRow(y, z, min.X, max.X, classes);
+            std::fill_n(row, rowLength, blockType);
+            layerChanged = true;
+        }
+        if (layerChanged)
+            m_DirtySections |= MeshBuilder::SectionsForRows(y, y);
+        changed |= layerChanged;
+    }
+    if (changed && blockType != BlockType::Air)
         m_PotentiallyHasBlocks = true;
-    m_Blocks[ChunkUtils::PackXYZ(x, y, z)] = blockType;
 }
 
-void Chunk::RebuildMesh(const World& world)
+Chunk* Chunk::GetNeighbor(BlockFace face)
+{
+    const BlockCoords normal =
+        ChunkUtils::k_FaceNormals[static_cast<size_t>(face)];
+    return GetNeighbor(normal.X, normal.Y, normal.Z);
+}
+
+void Chunk::LinkNeighbor(Chunk* neighbor, size_t index)
+{
+    assert(index != ChunkUtils::k_CenterNeighborSlot);
+    assert(m_Neighbors[index] == nullptr);
+    const size_t opposite = ChunkUtils::OppositeNeighborIndex(index);
+    m_Neighbors[index] = neighbor;
+    m_NumNeighbors++;
+    neighbor->m_Neighbors[opposite] = this;
+    neighbor->m_NumNeighbors++;
+}
+
+void Chunk::UnlinkNeighbors()
+{
+    for (size_t i = 0; i < ChunkUtils::k_NumNeighborSlots; i++)
+    {
+        if (i == ChunkUtils::k_CenterNeighborSlot || !m_Neighbors[i])
+            continue;
+
+        Chunk* const neighbor = m_Neighbors[i];
+        neighbor->m_Neighbors[ChunkUtils::OppositeNeighborIndex(i)] = nullptr;
+        neighbor->m_NumNeighbors--;
+        m_Neighbors[i] = nullptr;
+    }
+    m_NumNeighbors = 0;
+}
+
+void Chunk::TakeNeighbors(Chunk& other)
+{
+    m_Neighbors = other.m_Neighbors;
+    m_NumNeighbors = other.m_NumNeighbors;
+    m_Neighbors[ChunkUtils::k_CenterNeighborSlot] = this;
+    for (size_t i = 0; i < ChunkUtils::k_NumNeighborSlots; i++)
+    {
+        if (i != ChunkUtils::k_CenterNeighborSlot && m_Neighbors[i])
+            m_Neighbors[i]->m_Neighbors[ChunkUtils::OppositeNeighborIndex(i)] =
+                this;
+    }
+
+    other.m_Neighbors = {};
+    other.m_Neighbors[ChunkUtils::k_CenterNeighborSlot] = &other;
+    other.m_NumNeighbors = 0;
+}
+
+uint64_t Chunk::FacingBorderHash(size_t face) const
+{
+    const BlockCoords normal = ChunkUtils::k_FaceNormals[face];
+    const Chunk* const neighbor = GetNeighbor(normal.X, normal.Y, normal.Z);
+    if (!neighbor)
+        return 0;
+    return neighbor->GetBorderHash(OppositeFace(static_cast<BlockFace>(face)));
+}
+
+bool Chunk::MeshInputsChanged() const
+{
+    if (!m_HasMeshedHashes || m_ContentHash != m_MeshedContentHash)
+        return true;
+
+    for (size_t face = 0; face < k_NumFaces; face++)
+    {
+        if (FacingBorderHash(face) != m_MeshedNeighborBorders[face])
+            return true;
+    }
+    return false;
+}
+
+uint64_t Chunk::DiagonalOcclusionHash() const
+{
+    constexpr uint8_t last = CHUNK_DIMENSION - 1;
+
+    uint64_t hash = 0;
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                const int numAxes = (dx != 0) + (dy != 0) + (dz != 0);
+                const Chunk* const neighbor = GetNeighbor(dx, dy, dz);
+                if (numAxes < 2 || !neighbor)
+                    continue;
+
+                // The neighbor's blocks touching this chunk's edge or corner
+                const ChunkOccupancy& occupancy = neighbor->GetOccupancy();
+                const uint8_t x = dx < 0 ? last : 0;
+                const uint8_t y = dy < 0 ? last : 0;
+                const uint8_t z = dz < 0 ? last : 0;
+                uint32_t bits = 0;
+                if (numAxes == 3)
+                    bits = occupancy.Test(OccupancyClass::Opaque, {x, y, z});
+                else if (dx == 0)
+                    bits = occupancy.ColumnX(OccupancyClass::Opaque, y, z);
+                else if (dy == 0)
+                    bits = occupancy.ColumnY(OccupancyClass::Opaque, x, z);
+                else
+                    bits = occupancy.ColumnZ(OccupancyClass::Opaque, x, y);
+
+                // Skipped like unloaded neighbors, which mesh the same
+                if (bits == 0)
+                    continue;
+                const uint64_t index = ChunkUtils::NeighborIndex(dx, dy, dz);
+                hash = HashCombine(hash, (index << 32) | bits);
+            }
+        }
+    }
+    return hash;
+}
+
+uint64_t Chunk::GetMeshKey() const
 {
-    m_Mesh.Rebuild(*this, world);
-    m_NeedsRebuild = false;
+    uint64_t key = HashCombine(MeshBuilder::VERSION, m_ContentHash);
+    for (size_t face = 0; face < k_NumFaces; face++)
+        key = HashCombine(key, FacingBorderHash(face));
+    return HashCombine(key, DiagonalOcclusionHash());
+}
+
+void Chunk::RecordMeshedHashes()
+{
+    m_MeshedContentHash = m_ContentHash;
+    for (size_t face = 0; face < k_NumFaces; face++)
+        m_MeshedNeighborBorders[face] = FacingBorderHash(face);
+    m_HasMeshedHashes = true;
+}
+
+bool Chunk::BuildMesh(MeshCache* cache)
+{
+    // Depends on nothing but the chunk's own blocks
+    if (!m_HasMeshedHashes || m_ContentHash != m_MeshedContentHash)
+    {
+        m_Visibility = ChunkVisibility::Compute(*m_Occupancy);
+        m_Occluder = ChunkOccluder::Compute(*m_Occupancy);
+    }
+
+    // Later meshes come from edits and neighbors changing, which hardly ever
+    // produce a mesh that gets looked up again
+    const bool edited =
+        m_HasMeshedHashes && m_ContentHash != m_MeshedContentHash;
+    const bool useCache = cache && !m_TriedMeshCache && !edited;
+    m_TriedMeshCache = m_TriedMeshCache || cache;
+    if (!useCache)
+    {
+        m_Mesh.Build(*this, m_DirtySections);
+        m_DirtySections = 0;
+        RecordMeshedHashes();
+        return false;
+    }
+
+    const uint64_t key = GetMeshKey();
+    const bool cached = cache->Load(key, m_Mesh);
+    if (!cached)
+    {
+        // Entries have to be complete meshes
+        m_Mesh.Build(*this, MeshBuilder::ALL_SECTIONS);
+        cache->Store(key, m_Mesh);
+    }
+    // Not cached, it takes a fraction of the time of the full mesh to build
+    if (cached && Config::EnableShadowMeshes)
+        m_Mesh.BuildShadow(*this);
+    m_DirtySections = 0;
+    RecordMeshedHashes();
+    return cached;
 }
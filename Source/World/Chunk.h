@@ -2,14 +2,22 @@
 
 #include "Block.h"
 #include "ChunkMesh.h"
+#include "ChunkOccluder.h"
+#include "ChunkOccupancy.h"
+#include "ChunkUtils.h"
+#include "ChunkVisibility.h"
 #include "World/Coordinates.h"
+#include <array>
 
-class World;
+class MeshCache;
 
 class Chunk
 {
   public:
-    Chunk(ChunkCoords coords);
+    // Chunks of a LOD level above zero stand in for 2^level regular chunks
+    // per axis, each of their blocks covering 2^level blocks per axis.
+    // Coordinates are then in units of those larger chunks
+    Chunk(ChunkCoords coords, uint8_t lodLevel = 0);
     Chunk();
 
     ~Chunk();
@@ -25,31 +33,136 @@ class Chunk
     ChunkCoords GetCoords() const { return m_Coords; };
     void SetCoords(ChunkCoords coords) { m_Coords = coords; }
 
+    uint8_t GetLodLevel() const { return m_LodLevel; }
+    // Width of one of the chunk's blocks, in blocks
+    int GetScale() const { return 1 << m_LodLevel; }
+    // World position of the chunk's first block
+    BlockCoords GetOrigin() const
+    {
+        const int size = CHUNK_DIMENSION * GetScale();
+        return {m_Coords.X * size, m_Coords.Y * size, m_Coords.Z * size};
+    }
+
     const ChunkMesh& GetMesh() const { return m_Mesh; }
+    // As of the last mesh build, every face connected before that
+    const ChunkVisibility& GetVisibility() const { return m_Visibility; }
+    // As of the last mesh build, empty before that
+    const ChunkOccluder& GetOccluder() const { return m_Occluder; }
 
     BlockType GetBlock(size_t i) const;
     BlockType GetBlock(uint8_t x, uint8_t y, uint8_t z) const;
 
     void SetBlock(BlockType blockType, size_t i);
     void SetBlock(BlockType blockType, uint8_t x, uint8_t y, uint8_t z);
+    // Fills the box between min and max, both inclusive, a row at a time
+    void FillBlocks(BlockType blockType, LocalBlockCoords min,
+                    LocalBlockCoords max);
 
     BlockType* GetBlocks() { return m_Blocks; }
     const BlockType* GetBlocks() const { return m_Blocks; }
 
     void SetBlocks(BlockType* blocks) { m_Blocks = blocks; }
 
-    void RebuildMesh(const World& world);
-    void TriggerRebuild() { m_NeedsRebuild = true; }
+    // Kept in sync with the blocks by every write
+    const ChunkOccupancy& GetOccupancy() const { return *m_Occupancy; }
+
+    // Offsets are in chunks and in [-1, 1], nullptr if that neighbor isn't
+    // loaded. The offset (0, 0, 0) is the chunk itself
+    Chunk* GetNeighbor(int dx, int dy, int dz)
+    {
+        return m_Neighbors[ChunkUtils::NeighborIndex(dx, dy, dz)];
+    }
+    const Chunk* GetNeighbor(int dx, int dy, int dz) const
+    {
+        return m_Neighbors[ChunkUtils::NeighborIndex(dx, dy, dz)];
+    }
+    Chunk* GetNeighbor(BlockFace face);
+
+    bool HasAllNeighbors() const
+    {
+        return m_NumNeighbors == ChunkUtils::k_NumNeighborSlots - 1;
+    }
+
+    // Links both chunks to each other, index is from ChunkUtils::NeighborIndex
+    void LinkNeighbor(Chunk* neighbor, size_t index);
+    // Removes this chunk from all of its neighbors, done on destruction
+    void UnlinkNeighbors();
+
+    // Builds the dirty sections. With a cache, the complete mesh is looked up
+    // first and stored on a miss, but only for the first mesh given a cache
+    // since the chunk was loaded, and not if the chunk's own blocks changed
+    // since its last mesh. Callers pass one once every neighbor the chunk
+    // will get is linked. Returns whether the mesh came from the cache
+    bool BuildMesh(MeshCache* cache = nullptr);
+    void UploadMesh() { m_Mesh.Upload(); }
+    bool NeedsUpload() const { return m_Mesh.HasPendingUpload(); }
+
+    // Sections is a mask of MeshBuilder sections
+    void TriggerRebuild(uint8_t sections = MeshBuilder::ALL_SECTIONS)
+    {
+        m_DirtySections |= sections;
+    }
     bool NeedsRebuild() const
     {
-        return m_NeedsRebuild && m_PotentiallyHasBlocks;
+        return m_DirtySections != 0 && m_PotentiallyHasBlocks;
     }
+    uint8_t GetDirtySections() const { return m_DirtySections; }
+
+    // Order independent hashes of the blocks, kept up to date on every write.
+    // Air hashes to zero, so an empty chunk or slab has a hash of zero, the
+    // same as a neighbor that isn't loaded
+    uint64_t GetContentHash() const { return m_ContentHash; }
+    // Hash of the one block thick slab along that face of the chunk
+    uint64_t GetBorderHash(BlockFace face) const
+    {
+        return m_BorderHashes[static_cast<size_t>(face)];
+    }
+
+    // Whether the chunk's blocks or the facing border slabs of its neighbors
+    // changed since the mesh was last built. If not, a pending rebuild would
+    // produce the same mesh. Diagonal neighbors are not tracked, they never
+    // trigger rebuilds in the first place
+    bool MeshInputsChanged() const;
+    void DiscardRebuild() { m_DirtySections = 0; }
+
+    // Hash of everything the complete mesh is built from: the chunk's blocks,
+    // the facing border slabs, the opaque blocks of the diagonal neighbors
+    // that ambient occlusion reaches and MeshBuilder::VERSION
+    uint64_t GetMeshKey() const;
+
+  private:
+    void TakeNeighbors(Chunk& other);
+
+    // Returns false if the block was already of that type
+    bool WriteBlock(BlockType blockType, size_t i);
+    // Hash of the neighbor's slab touching the given face, zero if unloaded
+    uint64_t FacingBorderHash(size_t face) const;
+    uint64_t DiagonalOcclusionHash() const;
+
+    void RecordMeshedHashes();
 
   private:
     BlockType* m_Blocks = nullptr;
+    ChunkOccupancy* m_Occupancy = nullptr;
     ChunkCoords m_Coords{};
+    uint8_t m_LodLevel = 0;
     ChunkMesh m_Mesh{};
+    ChunkVisibility m_Visibility{};
+    ChunkOccluder m_Occluder{};
+    std::array<Chunk*, ChunkUtils::k_NumNeighborSlots> m_Neighbors{};
+    size_t m_NumNeighbors = 0;
+
+    uint64_t m_ContentHash = 0;
+    std::array<uint64_t, static_cast<size_t>(BlockFace::Count)>
+        m_BorderHashes{};
+    // The hashes the current mesh was built from
+    uint64_t m_MeshedContentHash = 0;
+    std::array<uint64_t, static_cast<size_t>(BlockFace::Count)>
+        m_MeshedNeighborBorders{};
+    bool m_HasMeshedHashes = false;
+    // Only the first mesh built with all neighbors linked goes to the cache
+    bool m_TriedMeshCache = false;
 
-    bool m_NeedsRebuild = false;
+    uint8_t m_DirtySections = 0;
     bool m_PotentiallyHasBlocks = false;
 };
@@ -1,40 +1,116 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <span>
+#include <vector>
 #include "ChunkVertex.h"
-#include "Rendering/VertexArray.h"
-#include "Rendering/Buffer.h"
+#include "MeshBuilder.h"
 #include "Block.h"
 #include "World/Coordinates.h"
 
 class Chunk;
-class World;
+struct ChunkMeshBuffers;
+template <size_t N>
+class RangedVertexBuffer;
 
+// Set along with the buffers, so that a mesh that never got uploaded can be
+// destroyed without the GL code
+struct ChunkMeshBuffersDeleter
+{
+    void (*Delete)(ChunkMeshBuffers*) = nullptr;
+
+    void operator()(ChunkMeshBuffers* buffers) const { Delete(buffers); }
+};
+
+// The GL side of a chunk's mesh. Vertices are built by a MeshBuilder and kept
+// on the CPU until Upload(). The buffers themselves only get created on the
+// first upload, so chunks can be generated and meshed without a GL context.
+// Everything that touches them lives in Rendering/ChunkMeshBuffers.cpp, which
+// the headless world library leaves out
 class ChunkMesh
 {
   public:
-    ChunkMesh();
+    using SectionBuffer = RangedVertexBuffer<MeshBuilder::NUM_RANGES>;
+    // A range per direction
+    using ShadowBuffer = RangedVertexBuffer<MeshBuilder::NUM_FACES>;
+
+    ChunkMesh() = default;
+
+    // Also builds the shadow mesh when enabled, unless none of the sections
+    // changed what it's built from
+    void Build(const Chunk& chunk,
+               uint8_t sections = MeshBuilder::ALL_SECTIONS,
+               MeshingKernel kernel = MeshingKernel::Bitwise);
+    // Just the shadow mesh, for meshes that come from the MeshCache
+    void BuildShadow(const Chunk& chunk);
 
-    void Rebuild(const Chunk& chunk, const World& world);
+    // Replaces whatever is pending with a complete mesh built elsewhere, e.g.
+    // loaded from the MeshCache
+    void SetPending(
+        std::span<const ChunkVertex> opaque,
+        const std::array<uint32_t, MeshBuilder::NUM_RANGES>& opaqueCounts,
+        std::span<const ChunkVertex> transparent,
+        const std::array<uint32_t, MeshBuilder::NUM_RANGES>& transparentCounts);
 
-    size_t NumOpaqueVertices() const { return m_BufferIndex; }
-    size_t NumTransparentVertices() const { return m_TransparentBufferIndex; }
+    void Upload();
+
+    bool HasPendingUpload() const
+    {
+        return m_PendingSections != 0 || m_HasPendingShadow;
+    }
+    // Different after every Upload(), across all meshes, and 0 before the
+    // first. Lets whatever caches a drawing of the mesh tell it changed
+    uint64_t GetUploadStamp() const { return m_UploadStamp; }
+
+    const std::vector<ChunkVertex>& GetPendingOpaque() const
+    {
+        return m_PendingOpaque;
+    }
+    const std::vector<ChunkVertex>& GetPendingTransparent() const
+    {
+        return m_PendingTransparent;
+    }
+    const std::array<uint32_t, MeshBuilder::NUM_RANGES>&
+    GetPendingOpaqueCounts() const
+    {
+        return m_PendingOpaqueCounts;
+    }
+    const std::array<uint32_t, MeshBuilder::NUM_RANGES>&
+    GetPendingTransparentCounts() const
+    {
+        return m_PendingTransparentCounts;
+    }
+
+    size_t NumOpaqueVertices() const;
+    size_t NumTransparentVertices() const;
+    size_t NumShadowVertices() const;
+
+    // Only valid once the mesh has been uploaded
+    const SectionBuffer& GetOpaque() const;
+    const SectionBuffer& GetTransparent() const;
+    const ShadowBuffer& GetShadow() const;
 
     void BindOpaque() const;
     void BindTransparent() const;
+    void BindShadow() const;
 
   private:
-    void HandleBlock(const Chunk& chunk, const World& world, size_t i);
-
-    void AddFace(const Chunk& chunk, const World& world, BlockFace face,
-                 BlockType blockType, LocalBlockCoords offset);
+    void RebuildShadow(const Chunk& chunk);
 
-  private:
-    size_t m_BufferIndex = 0;
-    size_t m_TransparentBufferIndex = 0;
-    VertexBuffer m_OpaqueVBO{};
-    VertexBuffer m_TransparentVBO{};
-    VertexArray m_OpaqueVAO{};
-    VertexArray m_TransparentVAO{};
+    std::vector<ChunkVertex> m_PendingOpaque{};
+    std::vector<ChunkVertex> m_PendingTransparent{};
+    std::array<uint32_t, MeshBuilder::NUM_RANGES> m_PendingOpaqueCounts{};
+    std::array<uint32_t, MeshBuilder::NUM_RANGES> m_PendingTransparentCounts{};
+    uint8_t m_PendingSections = 0;
+    std::vector<ChunkVertex> m_PendingShadow{};
+    std::array<uint32_t, MeshBuilder::NUM_FACES> m_PendingShadowCounts{};
+    bool m_HasPendingShadow = false;
+    // MeshBuilder::HashShadowInputs() of each section as of the last shadow
+    // build
+    std::array<uint64_t, MeshBuilder::NUM_SECTIONS> m_ShadowInputs{};
+    bool m_HasShadowInputs = false;
+    uint64_t m_UploadStamp = 0;
+    std::unique_ptr<ChunkMeshBuffers, ChunkMeshBuffersDeleter> m_Buffers{};
     // No index buffer because vertices take up only 4 bytes
 };
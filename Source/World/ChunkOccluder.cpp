@@ -0,0 +1,74 @@
+#include "ChunkOccluder.h"
+#include "ChunkOccupancy.h"
+#include <bit>
+
+static_assert(CHUNK_DIMENSION == 32, "Slabs are stored as uint32_t");
+
+struct Run
+{
+    int First = 0;
+    int Length = 0;
+};
+
+static Run LongestRun(uint32_t mask)
+{
+    Run longest{};
+    int offset = 0;
+    while (mask)
+    {
+        const int zeros = std::countr_zero(mask);
+        mask >>= zeros;
+        offset += zeros;
+        const int ones = std::countr_one(mask);
+        if (ones > longest.Length)
+            longest = {offset, ones};
+        // Shifting a uint32_t by 32 is undefined
+        mask = ones == 32 ? 0 : mask >> ones;
+        offset += ones;
+    }
+    return longest;
+}
+
+ChunkOccluder ChunkOccluder::Compute(const ChunkOccupancy& occupancy)
+{
+    // Bit i is set when the slab at i along that axis is entirely opaque
+    uint32_t slabsX = ~0u;
+    uint32_t slabsY = ~0u;
+    uint32_t slabsZ = ~0u;
+    for (uint8_t a = 0; a < CHUNK_DIMENSION; a++)
+    {
+        for (uint8_t b = 0; b < CHUNK_DIMENSION; b++)
+        {
+            slabsX &= occupancy.ColumnX(OccupancyClass::Opaque, a, b);
+            slabsY &= occupancy.ColumnY(OccupancyClass::Opaque, a, b);
+            slabsZ &= occupancy.ColumnZ(OccupancyClass::Opaque, a, b);
+        }
+    }
+
+    const Run runX = LongestRun(slabsX);
+    const Run runY = LongestRun(slabsY);
+    const Run runZ = LongestRun(slabsZ);
+
+    constexpr uint8_t dim = CHUNK_DIMENSION;
+    ChunkOccluder occluder{};
+    if (runY.Length > 0 && runY.Length >= runX.Length &&
+        runY.Length >= runZ.Length)
+    {
+        occluder.Min = {0, static_cast<uint8_t>(runY.First), 0};
+        occluder.Max = {dim, static_cast<uint8_t>(runY.First + runY.Length),
+                        dim};
+    }
+    else if (runX.Length > 0 && runX.Length >= runZ.Length)
+    {
+        occluder.Min = {static_cast<uint8_t>(runX.First), 0, 0};
+        occluder.Max = {static_cast<uint8_t>(runX.First + runX.Length), dim,
+                        dim};
+    }
+    else if (runZ.Length > 0)
+    {
+        occluder.Min = {0, 0, static_cast<uint8_t>(runZ.First)};
+        occluder.Max = {dim, dim,
+                        static_cast<uint8_t>(runZ.First + runZ.Length)};
+    }
+    return occluder;
+}
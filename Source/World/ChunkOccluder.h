@@ -0,0 +1,20 @@
+#pragma once
+
+#include "World/Coordinates.h"
+
+class ChunkOccupancy;
+
+// A box of opaque blocks inside a chunk, for occlusion culling to rasterize in
+// place of the chunk's faces. It's the longest run of slabs along one axis
+// that are opaque all the way through, so solid chunks get the whole chunk
+// and ground chunks everything below the lowest point of their surface
+struct ChunkOccluder
+{
+    // In blocks from the chunk's origin, max exclusive
+    LocalBlockCoords Min{};
+    LocalBlockCoords Max{};
+
+    bool IsEmpty() const { return Max.X == Min.X; }
+
+    static ChunkOccluder Compute(const ChunkOccupancy& occupancy);
+};
@@ -0,0 +1,79 @@
+#include "ChunkOccupancy.h"
+#include <bit>
+
+static_assert(CHUNK_DIMENSION == 32, "Columns are stored as uint32_t");
+
+static const std::array<uint8_t, static_cast<size_t>(BlockType::NumBlockTypes)>
+    s_ClassMasks = []
+{
+    std::array<uint8_t, static_cast<size_t>(BlockType::NumBlockTypes)>
+        masks{};
+    for (size_t i = 0; i < masks.size(); i++)
+    {
+        const BlockType blockType = static_cast<BlockType>(i);
+        if (blockType == BlockType::Air)
+            continue;
+
+        masks[i] = 1u << static_cast<int>(OccupancyClass::NonAir);
+        masks[i] |= IsTranslucent(blockType)
+                        ? 1u << static_cast<int>(OccupancyClass::Translucent)
+                        : 1u << static_cast<int>(OccupancyClass::Opaque);
+    }
+    return masks;
+}();
+
+uint8_t ChunkOccupancy::GetClasses(BlockType blockType)
+{
+    return s_ClassMasks[static_cast<size_t>(blockType)];
+}
+
+void ChunkOccupancy::Clear()
+{
+    m_ColumnsX = {};
+    m_ColumnsY = {};
+    m_ColumnsZ = {};
+}
+
+void ChunkOccupancy::Update(LocalBlockCoords coords, uint8_t oldClasses,
+                            uint8_t newClasses)
+{
+    const size_t xColumn = coords.Y * CHUNK_DIMENSION_U + coords.Z;
+    const size_t yColumn = coords.Z * CHUNK_DIMENSION_U + coords.X;
+    const size_t zColumn = coords.Y * CHUNK_DIMENSION_U + coords.X;
+
+    for (uint8_t changed = oldClasses ^ newClasses; changed != 0;
+         changed &= changed - 1)
+    {
+        const int occupancyClass = std::countr_zero(changed);
+        m_ColumnsX[occupancyClass][xColumn] ^= 1u << coords.X;
+        m_ColumnsY[occupancyClass][yColumn] ^= 1u << coords.Y;
+        m_ColumnsZ[occupancyClass][zColumn] ^= 1u << coords.Z;
+    }
+}
+
+void ChunkOccupancy::FillRow(uint8_t y, uint8_t z, uint8_t minX, uint8_t maxX,
+                             uint8_t classes)
+{
+    const uint32_t rowMask = (~0u >> (31 - (maxX - minX))) << minX;
+    const uint32_t yBit = 1u << y;
+    const uint32_t zBit = 1u << z;
+    for (size_t occupancyClass = 0;
+         occupancyClass < static_cast<size_t>(OccupancyClass::Count);
+         occupancyClass++)
+    {
+        const bool set = (classes >> occupancyClass) & 1u;
+        // The whole row is one column along x
+        uint32_t& columnX =
+            m_ColumnsX[occupancyClass][y * CHUNK_DIMENSION_U + z];
+        columnX = set ? columnX | rowMask : columnX & ~rowMask;
+        for (uint8_t x = minX; x <= maxX; x++)
+        {
+            uint32_t& columnY =
+                m_ColumnsY[occupancyClass][z * CHUNK_DIMENSION_U + x];
+            uint32_t& columnZ =
+                m_ColumnsZ[occupancyClass][y * CHUNK_DIMENSION_U + x];
+            columnY = set ? columnY | yBit : columnY & ~yBit;
+            columnZ = set ? columnZ | zBit : columnZ & ~zBit;
+        }
+    }
+}
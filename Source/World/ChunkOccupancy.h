@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Block.h"
+#include "Core/Common.h"
+#include "World/Coordinates.h"
+#include <array>
+#include <cstdint>
+
+enum class OccupancyClass : uint8_t
+{
+    // Hides the faces of whatever is next to it
+    Opaque = 0,
+    // Leaves and water
+    Translucent,
+    NonAir,
+    Count
+};
+
+// One bit per block for each OccupancyClass, laid out as 32x32 columns of 32
+// bits along every axis, so that a whole row of blocks can be tested or
+// combined with shifts and masks instead of looking up block types
+class ChunkOccupancy
+{
+  public:
+    // Mask of (1 << OccupancyClass) that the block type belongs to
+    static uint8_t GetClasses(BlockType blockType);
+
+    // Back to all air
+    void Clear();
+
+    // Flips the bits of the classes that differ between the two masks
+    void Update(LocalBlockCoords coords, uint8_t oldClasses,
+                uint8_t newClasses);
+    // Sets the classes of the blocks from minX to maxX, both inclusive, in
+    // the row at y and z
+    void FillRow(uint8_t y, uint8_t z, uint8_t minX, uint8_t maxX,
+                 uint8_t classes);
+
+    // Bit x is the block at (x, y, z)
+    uint32_t ColumnX(OccupancyClass occupancyClass, uint8_t y,
+                     uint8_t z) const
+    {
+        return m_ColumnsX[static_cast<size_t>(occupancyClass)]
+                         [y * CHUNK_DIMENSION_U + z];
+    }
+    // Bit y is the block at (x, y, z)
+    uint32_t ColumnY(OccupancyClass occupancyClass, uint8_t x,
+                     uint8_t z) const
+    {
+        return m_ColumnsY[static_cast<size_t>(occupancyClass)]
+                         [z * CHUNK_DIMENSION_U + x];
+    }
+    // Bit z is the block at (x, y, z)
+    uint32_t ColumnZ(OccupancyClass occupancyClass, uint8_t x,
+                     uint8_t y) const
+    {
+        return m_ColumnsZ[static_cast<size_t>(occupancyClass)]
+                         [y * CHUNK_DIMENSION_U + x];
+    }
+
+    bool Test(OccupancyClass occupancyClass, LocalBlockCoords coords) const
+    {
+        return (ColumnX(occupancyClass, coords.Y, coords.Z) >> coords.X) & 1u;
+    }
+
+  private:
+    using Columns = std::array<uint32_t, CHUNK_AREA_U>;
+    using ClassColumns =
+        std::array<Columns, static_cast<size_t>(OccupancyClass::Count)>;
+
+    ClassColumns m_ColumnsX;
+    ClassColumns m_ColumnsY;
+    ClassColumns m_ColumnsZ;
+};
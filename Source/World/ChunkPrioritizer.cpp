@@ -0,0 +1,76 @@
+#include "ChunkPrioritizer.h"
+#include "Rendering/Camera.h"
+
+// Chunks outside the frustum are treated as this many times further away
+static constexpr float k_OutOfViewPenalty = 4.0f;
+// How much moving towards or away from a chunk scales its priority
+static constexpr float k_VelocityWeight = 0.5f;
+// Below this speed, in blocks per tick, the player counts as standing still
+static constexpr float k_MinSpeed = 0.01f;
+// The chunks around the player are needed for collisions, so they are always
+// loaded in distance order regardless of the view
+static constexpr int k_ImmediateDistanceSq = 3;
+
+static constexpr float k_ChunkRadius = CHUNK_DIMENSION * 0.8660254f;
+
+void ChunkPrioritizer::Update(ChunkCoords playerChunk, WorldCoords velocity,
+                              const Camera* camera)
+{
+    m_PlayerChunk = playerChunk;
+
+    m_IsMoving = velocity.Length() > k_MinSpeed;
+    if (m_IsMoving)
+    {
+        velocity.Normalize();
+        m_MoveDir = static_cast<glm::vec3>(velocity);
+    }
+
+    m_HasFrustum = camera != nullptr;
+    if (m_HasFrustum)
+    {
+        std::array<Plane, 6> planes;
+        camera->GetFrustumPlanes(planes);
+        for (size_t i = 0; i < planes.size(); i++)
+        {
+            m_FrustumPlanes[i] =
+                glm::vec4{planes[i].Normal,
+                          -glm::dot(planes[i].Normal, planes[i].P0)};
+        }
+    }
+}
+
+float ChunkPrioritizer::GetPriority(ChunkCoords coords) const
+{
+    const ChunkCoords diff = coords - m_PlayerChunk;
+    const int distSq = diff.NormSq();
+    float priority = static_cast<float>(distSq);
+    if (!m_ViewAware || distSq <= k_ImmediateDistanceSq)
+        return priority;
+
+    if (m_HasFrustum && !InFrustum(coords))
+        priority *= k_OutOfViewPenalty;
+
+    if (m_IsMoving)
+    {
+        const glm::vec3 dir = glm::normalize(glm::vec3{
+            static_cast<float>(diff.X), static_cast<float>(diff.Y),
+            static_cast<float>(diff.Z)});
+        priority *= 1.0f - k_VelocityWeight * glm::dot(dir, m_MoveDir);
+    }
+    return priority;
+}
+
+bool ChunkPrioritizer::InFrustum(ChunkCoords coords) const
+{
+    // Bounding sphere test, cheaper than the corner test used for rendering and
+    // exact enough for ordering
+    constexpr float l = static_cast<float>(CHUNK_DIMENSION);
+    const glm::vec3 center{(coords.X + 0.5f) * l, (coords.Y + 0.5f) * l,
+                           (coords.Z + 0.5f) * l};
+    for (const glm::vec4& plane : m_FrustumPlanes)
+    {
+        if (glm::dot(glm::vec3{plane}, center) + plane.w < -k_ChunkRadius)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Coordinates.h"
+#include <array>
+#include <glm/glm.hpp>
+
+class Camera;
+
+// A value tagged with its priority, ordered so that the std heap algorithms
+// pop the most urgent (lowest priority) entry first
+template <typename T>
+struct Prioritized
+{
+    T Value;
+    float Priority;
+
+    bool operator<(const Prioritized& other) const
+    {
+        return Priority > other.Priority;
+    }
+};
+
+// Orders streaming work so that the chunks the player is looking at, or moving
+// towards, get generated and meshed before the ones behind them. The priority
+// is the squared chunk distance to the player, scaled up for chunks outside
+// the view frustum and scaled down for chunks in the direction of movement.
+// Lower priorities are more urgent
+class ChunkPrioritizer
+{
+  public:
+    // Refreshes the view state, called once per tick before the queues get
+    // reprioritized. Without a camera only distance and velocity are used
+    void Update(ChunkCoords playerChunk, WorldCoords velocity,
+                const Camera* camera);
+
+    float GetPriority(ChunkCoords coords) const;
+
+    void SetViewAware(bool viewAware) { m_ViewAware = viewAware; }
+    bool IsViewAware() const { return m_ViewAware; }
+
+  private:
+    bool InFrustum(ChunkCoords coords) const;
+
+  private:
+    // Planes as (normal, distance), with the inside being positive
+    std::array<glm::vec4, 6> m_FrustumPlanes{};
+    glm::vec3 m_MoveDir{};
+    ChunkCoords m_PlayerChunk{};
+
+    bool m_HasFrustum = false;
+    bool m_IsMoving = false;
+    bool m_ViewAware = true;
+};
@@ -23,6 +23,21 @@ inline constexpr std::array<BlockCoords, static_cast<size_t>(BlockFace::Count)>
                    // Bottom
                    {0, -1, 0}}};
 
+// Neighbor slots of a chunk, for offsets in [-1, 1] on every axis. The center
+// slot is the chunk itself
+inline constexpr size_t k_NumNeighborSlots = 27;
+inline constexpr size_t k_CenterNeighborSlot = 13;
+
+inline constexpr size_t NeighborIndex(int dx, int dy, int dz)
+{
+    return static_cast<size_t>((dx + 1) + (dy + 1) * 3 + (dz + 1) * 9);
+}
+
+inline constexpr size_t OppositeNeighborIndex(size_t index)
+{
+    return k_NumNeighborSlots - 1 - index;
+}
+
 inline size_t NeighboringChunks(ChunkCoords chunkCoords, uint8_t blockX,
                                 uint8_t blockY, uint8_t blockZ,
                                 std::array<ChunkCoords, 3>& neighbors)
@@ -1,16 +1,8 @@
 #include "ChunkVertex.h"
 #include "Chunk.h"
 #include <cassert>
-#include "Rendering/VertexArray.h"
 #include <array>
 
-const BufferLayout& ChunkVertex::GetBufferLayout()
-{
-    static BufferLayout layout{{LayoutElementType::UInt, 1},
-                               {LayoutElementType::UInt, 1}};
-    return layout;
-}
-
 void ChunkVertex::Offset(uint8_t x, uint8_t y, uint8_t z)
 {
     assert(x <= CHUNK_DIMENSION && y <= CHUNK_DIMENSION &&
@@ -4,8 +4,6 @@
 #include "World/Coordinates.h"
 #include <cstdint>
 
-class BufferLayout;
-
 // Bits 0-5   : X offset
 // Bits 6-11  : Y offset
 // Bits 12-17 : Z offset
@@ -20,7 +18,6 @@ class BufferLayout;
 class ChunkVertex
 {
   public:
-    static const BufferLayout& GetBufferLayout();
     static constexpr size_t VERTICES_PER_FACE = 6;
 
     constexpr ChunkVertex() = default;
@@ -31,14 +28,14 @@ class ChunkVertex
     {
     }
 
-    LocalBlockCoords GetLocalCoords() const
+    constexpr LocalBlockCoords GetLocalCoords() const
     {
         return {static_cast<uint8_t>(m_Encoding & 0x3Fu),
                 static_cast<uint8_t>((m_Encoding >> 6u) & 0x3Fu),
                 static_cast<uint8_t>((m_Encoding >> 12u) & 0x3Fu)};
     }
 
-    BlockFace GetFace() const
+    constexpr BlockFace GetFace() const
     {
         return static_cast<BlockFace>((m_Encoding >> 28u) & 0x7u);
     }
@@ -0,0 +1,126 @@
+#include "ChunkVisibility.h"
+#include "ChunkOccupancy.h"
+#include <bit>
+#include <vector>
+
+static_assert(CHUNK_DIMENSION == 32, "Rows are stored as uint32_t");
+
+static constexpr uint8_t FaceBit(BlockFace face)
+{
+    return static_cast<uint8_t>(1u << static_cast<int>(face));
+}
+
+// The contiguous bits of mask around bit, which has to be set in mask
+static uint32_t RunAround(uint32_t mask, uint32_t bit)
+{
+    // Adding bit to the set bits from it upward carries through the run
+    const uint32_t above = mask & ~(bit - 1);
+    const uint32_t up = above & ~(above + bit);
+    const uint32_t gaps = ~mask & (bit - 1);
+    const uint32_t down =
+        gaps ? (bit - 1) & ~((std::bit_floor(gaps) << 1) - 1) : bit - 1;
+    return up | down;
+}
+
+ChunkVisibility ChunkVisibility::Compute(const ChunkOccupancy& occupancy)
+{
+    struct Run
+    {
+        uint16_t Row;
+        uint32_t Bits;
+    };
+
+    // Bit x of row y * CHUNK_DIMENSION + z is the block at (x, y, z)
+    std::array<uint32_t, CHUNK_AREA_U> open;
+    uint32_t anyOpen = 0;
+    uint32_t allOpen = ~0u;
+    for (uint8_t y = 0; y < CHUNK_DIMENSION; y++)
+    {
+        for (uint8_t z = 0; z < CHUNK_DIMENSION; z++)
+        {
+            const uint32_t row =
+                ~occupancy.ColumnX(OccupancyClass::Opaque, y, z);
+            open[y * CHUNK_DIMENSION_U + z] = row;
+            anyOpen |= row;
+            allOpen &= row;
+        }
+    }
+
+    ChunkVisibility visibility{};
+    if (allOpen == ~0u)
+        return visibility;
+    visibility.m_Connections.fill(0);
+    if (anyOpen == 0)
+        return visibility;
+
+    std::array<uint32_t, CHUNK_AREA_U> visited{};
+    std::vector<Run> stack{};
+    stack.reserve(CHUNK_AREA_U);
+
+    const auto push = [&](size_t row, uint32_t bit)
+    {
+        const uint32_t run = RunAround(open[row], bit);
+        visited[row] |= run;
+        stack.push_back({static_cast<uint16_t>(row), run});
+    };
+    // Every run of the neighboring row touching this one
+    const auto spread = [&](size_t row, uint32_t bits)
+    {
+        uint32_t unvisited = bits & open[row] & ~visited[row];
+        while (unvisited)
+        {
+            const uint32_t bit = unvisited & (~unvisited + 1);
+            push(row, bit);
+            unvisited &= ~visited[row];
+        }
+    };
+
+    for (size_t seedRow = 0; seedRow < CHUNK_AREA_U; seedRow++)
+    {
+        uint32_t seeds = open[seedRow] & ~visited[seedRow];
+        while (seeds)
+        {
+            // One connected region at a time, noting the faces it reaches
+            uint8_t faces = 0;
+            push(seedRow, seeds & (~seeds + 1));
+            while (!stack.empty())
+            {
+                const Run run = stack.back();
+                stack.pop_back();
+
+                const size_t y = run.Row / CHUNK_DIMENSION_U;
+                const size_t z = run.Row % CHUNK_DIMENSION_U;
+                if (run.Bits & 1u)
+                    faces |= FaceBit(BlockFace::NegX);
+                if (run.Bits >> (CHUNK_DIMENSION - 1))
+                    faces |= FaceBit(BlockFace::PosX);
+                if (y == 0)
+                    faces |= FaceBit(BlockFace::NegY);
+                if (y == CHUNK_DIMENSION_U - 1)
+                    faces |= FaceBit(BlockFace::PosY);
+                if (z == 0)
+                    faces |= FaceBit(BlockFace::NegZ);
+                if (z == CHUNK_DIMENSION_U - 1)
+                    faces |= FaceBit(BlockFace::PosZ);
+
+                if (y > 0)
+                    spread(run.Row - CHUNK_DIMENSION_U, run.Bits);
+                if (y < CHUNK_DIMENSION_U - 1)
+                    spread(run.Row + CHUNK_DIMENSION_U, run.Bits);
+                if (z > 0)
+                    spread(run.Row - 1, run.Bits);
+                if (z < CHUNK_DIMENSION_U - 1)
+                    spread(run.Row + 1, run.Bits);
+            }
+
+            for (size_t face = 0; face < visibility.m_Connections.size();
+                 face++)
+            {
+                if ((faces >> face) & 1u)
+                    visibility.m_Connections[face] |= faces;
+            }
+            seeds &= ~visited[seedRow];
+        }
+    }
+    return visibility;
+}
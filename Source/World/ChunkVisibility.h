@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Block.h"
+#include <array>
+#include <cstdint>
+
+class ChunkOccupancy;
+
+// Which pairs of a chunk's faces can see each other through the chunk, over
+// paths of blocks that aren't opaque. Faces that aren't connected can't be
+// looked through one from the other, which is what lets cave culling skip
+// everything behind terrain
+class ChunkVisibility
+{
+  public:
+    static constexpr uint8_t ALL_FACES =
+        (1u << static_cast<int>(BlockFace::Count)) - 1;
+
+    // Every face sees every other, right for an empty chunk and a safe
+    // default for one that was never meshed
+    ChunkVisibility() { m_Connections.fill(ALL_FACES); }
+
+    // Flood fills the blocks that aren't opaque, a row of them at a time
+    static ChunkVisibility Compute(const ChunkOccupancy& occupancy);
+
+    bool Connects(BlockFace a, BlockFace b) const
+    {
+        return (m_Connections[static_cast<size_t>(a)] >>
+                static_cast<int>(b)) &
+               1u;
+    }
+
+  private:
+    // Bit b of entry a is set when faces a and b are connected
+    std::array<uint8_t, static_cast<size_t>(BlockFace::Count)> m_Connections;
+};
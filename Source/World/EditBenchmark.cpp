@@ -0,0 +1,103 @@
+#include "EditBenchmark.h"
+#include "World.h"
+#include "Core/Logger.h"
+#include "ECS/Components.h"
+#include <chrono>
+#include <vector>
+
+static constexpr int k_RegionDimension = 64;
+
+// Both paths place the same blocks over the same contents
+static constexpr BlockType k_FillBlock = BlockType::Stone;
+
+static void SaveRegion(const World& world, BlockCoords min, BlockCoords max,
+                       std::vector<BlockType>& blocks)
+{
+    blocks.clear();
+    for (int y = min.Y; y <= max.Y; y++)
+    {
+        for (int z = min.Z; z <= max.Z; z++)
+        {
+            for (int x = min.X; x <= max.X; x++)
+            {
+                blocks.push_back(world.GetBlock({x, y, z}));
+            }
+        }
+    }
+}
+
+static void RestoreRegion(World& world, BlockCoords min, BlockCoords max,
+                          const std::vector<BlockType>& blocks)
+{
+    World::EditBatch batch = world.BeginEdit();
+    size_t i = 0;
+    for (int y = min.Y; y <= max.Y; y++)
+    {
+        for (int z = min.Z; z <= max.Z; z++)
+        {
+            for (int x = min.X; x <= max.X; x++)
+            {
+                batch.SetBlock(blocks[i++], {x, y, z});
+            }
+        }
+    }
+    batch.Commit();
+}
+
+void EditBenchmark::Run(World& world)
+{
+    using namespace std::chrono;
+
+    // Far enough down that the player doesn't end up inside the region
+    const BlockCoords playerBlock =
+        static_cast<BlockCoords>(world.GetPlayerView().Transform->Position);
+    const BlockCoords min = playerBlock + BlockCoords{-k_RegionDimension / 2,
+                                                      -k_RegionDimension - 32,
+                                                      -k_RegionDimension / 2};
+    const BlockCoords max =
+        min + BlockCoords{k_RegionDimension - 1, k_RegionDimension - 1,
+                          k_RegionDimension - 1};
+
+    std::vector<BlockType> saved;
+    SaveRegion(world, min, max, saved);
+
+    const high_resolution_clock::time_point placeStart =
+        high_resolution_clock::now();
+    for (int y = min.Y; y <= max.Y; y++)
+    {
+        for (int z = min.Z; z <= max.Z; z++)
+        {
+            for (int x = min.X; x <= max.X; x++)
+            {
+                world.PlaceBlock(k_FillBlock, {x, y, z});
+            }
+        }
+    }
+    const high_resolution_clock::time_point placeEnd =
+        high_resolution_clock::now();
+    RestoreRegion(world, min, max, saved);
+
+    const high_resolution_clock::time_point batchStart =
+        high_resolution_clock::now();
+    World::EditBatch batch = world.BeginEdit();
+    batch.Fill(k_FillBlock, min, max);
+    const size_t chunksWritten = batch.Commit();
+    const high_resolution_clock::time_point batchEnd =
+        high_resolution_clock::now();
+    RestoreRegion(world, min, max, saved);
+
+    constexpr float numBlocks = static_cast<float>(
+        k_RegionDimension * k_RegionDimension * k_RegionDimension);
+    const float placeMicros =
+        duration<float, std::micro>(placeEnd - placeStart).count();
+    const float batchMicros =
+        duration<float, std::micro>(batchEnd - batchStart).count();
+    const float placeNanosPerBlock = placeMicros * 1000.0f / numBlocks;
+    const float batchNanosPerBlock = batchMicros * 1000.0f / numBlocks;
+
+    LOG_INFO("Edit benchmark, {}^3 fill:", k_RegionDimension);
+    LOG_INFO("PlaceBlock: {:.1f} us ({:.2f} ns/block)", placeMicros,
+             placeNanosPerBlock);
+    LOG_INFO("EditBatch: {:.1f} us ({:.2f} ns/block, {} chunks)", batchMicros,
+             batchNanosPerBlock, chunksWritten);
+}
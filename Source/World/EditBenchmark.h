@@ -0,0 +1,12 @@
+#pragma once
+
+class World;
+
+namespace EditBenchmark
+{
+// Fills a 64x64x64 region below the player with stone twice, once a block at
+// a time through World::PlaceBlock() and once through a single
+// World::EditBatch, and logs how long each path took. The region gets back
+// what was in it before after each run
+void Run(World& world);
+} // namespace EditBenchmark
@@ -0,0 +1,149 @@
+#include "Horizon.h"
+#include "StreamingScheduler.h"
+#include "WorldGenerator.h"
+#include <cmath>
+
+static int FloorDiv(int a, int b)
+{
+    return a >= 0 ? a / b : (a - b + 1) / b;
+}
+
+static int CeilDiv(int a, int b)
+{
+    return -FloorDiv(-a, b);
+}
+
+Horizon::Horizon()
+{
+    for (size_t i = 0; i < m_Levels.size(); i++)
+    {
+        m_Levels[i].Spacing = Config::HorizonSpacing << i;
+        m_Levels[i].Samples.resize(NUM_SAMPLES * NUM_SAMPLES);
+        m_Storage[i].resize(NUM_SAMPLES * NUM_SAMPLES);
+    }
+}
+
+void Horizon::Update(WorldCoords playerPosition,
+                     const WorldGenerator& generator,
+                     StreamingScheduler& scheduler)
+{
+    const int playerX = static_cast<int>(std::floor(playerPosition.X));
+    const int playerZ = static_cast<int>(std::floor(playerPosition.Z));
+    const ChunkCoords playerChunk = static_cast<ChunkCoords>(playerPosition);
+
+    // Everything with chunks, in blocks. Same as the LOD rings' outer edge,
+    // or the render distance without them
+    constexpr int chunkSize = CHUNK_DIMENSION << Config::LodLevels;
+    constexpr int radius = Config::LodLevels > 0 ? Config::LodOuterRadius
+                                                 : Config::ChunkRenderDistance;
+    int holeMinX = ((playerChunk.X >> Config::LodLevels) - radius) * chunkSize;
+    int holeMinZ = ((playerChunk.Z >> Config::LodLevels) - radius) * chunkSize;
+    int holeMaxX =
+        ((playerChunk.X >> Config::LodLevels) + radius + 1) * chunkSize;
+    int holeMaxZ =
+        ((playerChunk.Z >> Config::LodLevels) + radius + 1) * chunkSize;
+
+    for (size_t i = 0; i < m_Levels.size(); i++)
+    {
+        const int spacing = m_Levels[i].Spacing;
+        Target& target = m_Targets[i];
+        // Centered on the nearest even sample, so that the outer edge lands
+        // on the samples of the next coarser level
+        const int centerX = FloorDiv(playerX + spacing, 2 * spacing) * 2;
+        const int centerZ = FloorDiv(playerZ + spacing, 2 * spacing) * 2;
+        target.OriginX = centerX - GRID_SIZE / 2;
+        target.OriginZ = centerZ - GRID_SIZE / 2;
+
+        // Only quads entirely inside the finer terrain are left out
+        target.HoleMinX = CeilDiv(holeMinX, spacing);
+        target.HoleMinZ = CeilDiv(holeMinZ, spacing);
+        target.HoleMaxX = FloorDiv(holeMaxX, spacing);
+        target.HoleMaxZ = FloorDiv(holeMaxZ, spacing);
+
+        holeMinX = target.OriginX * spacing;
+        holeMinZ = target.OriginZ * spacing;
+        holeMaxX = (target.OriginX + GRID_SIZE) * spacing;
+        holeMaxZ = (target.OriginZ + GRID_SIZE) * spacing;
+    }
+
+    // Finest level first, it is the nearest
+    bool resampled = true;
+    scheduler.BeginStage(StreamingStage::Horizon);
+    for (size_t i = 0; i < m_Levels.size() && resampled; i++)
+    {
+        const int originZ = m_Targets[i].OriginZ;
+        for (int gz = originZ; gz <= originZ + GRID_SIZE; gz++)
+        {
+            if (RowDone(i, gz))
+                continue;
+            if (!scheduler.NextUnit())
+            {
+                resampled = false;
+                break;
+            }
+            ResampleRow(i, gz, generator);
+        }
+    }
+    scheduler.EndStage();
+
+    if (resampled)
+        Publish();
+}
+
+bool Horizon::RowDone(size_t level, int gz) const
+{
+    const StoredRow& row = m_Rows[level][Wrap(gz)];
+    return row.Valid && row.Z == gz && row.OriginX == m_Targets[level].OriginX;
+}
+
+void Horizon::ResampleRow(size_t level, int gz,
+                          const WorldGenerator& generator)
+{
+    const int originX = m_Targets[level].OriginX;
+    const int spacing = m_Levels[level].Spacing;
+    std::vector<Sample>& samples = m_Storage[level];
+    StoredRow& row = m_Rows[level][Wrap(gz)];
+
+    const bool sameRow = row.Valid && row.Z == gz;
+    for (int gx = originX; gx <= originX + GRID_SIZE; gx++)
+    {
+        // Still where an earlier update put it
+        if (sameRow && gx >= row.OriginX && gx <= row.OriginX + GRID_SIZE)
+            continue;
+
+        const SurfaceSample surface =
+            generator.SampleSurface(gx * spacing, gz * spacing);
+        samples[Wrap(gz) * NUM_SAMPLES + Wrap(gx)] = {
+            static_cast<int16_t>(surface.Height), surface.Block};
+    }
+    row = {gz, originX, true};
+}
+
+// Only once every row of every level is in place, so that the renderer never
+// reads a level halfway through a move, and the holes always line up with the
+// finer levels that get drawn in them. The copy stays as it is while later
+// ticks resample the storage for the next move
+void Horizon::Publish()
+{
+    for (size_t i = 0; i < m_Levels.size(); i++)
+    {
+        Level& level = m_Levels[i];
+        const Target& target = m_Targets[i];
+        if (level.Revision != 0 && level.OriginX == target.OriginX &&
+            level.OriginZ == target.OriginZ &&
+            level.HoleMinX == target.HoleMinX &&
+            level.HoleMinZ == target.HoleMinZ &&
+            level.HoleMaxX == target.HoleMaxX &&
+            level.HoleMaxZ == target.HoleMaxZ)
+            continue;
+
+        level.OriginX = target.OriginX;
+        level.OriginZ = target.OriginZ;
+        level.HoleMinX = target.HoleMinX;
+        level.HoleMinZ = target.HoleMinZ;
+        level.HoleMaxX = target.HoleMaxX;
+        level.HoleMaxZ = target.HoleMaxZ;
+        level.Samples = m_Storage[i];
+        level.Revision++;
+    }
+}
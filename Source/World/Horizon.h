@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Block.h"
+#include "Core/Config.h"
+#include "World/Coordinates.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class StreamingScheduler;
+class WorldGenerator;
+
+// Terrain past the chunks, as clipmap levels of surface samples around the
+// player. Level k's samples are Config::HorizonSpacing << k blocks apart on a
+// grid of GRID_SIZE quads, with a hole where the next finer level, or the
+// chunks for level 0, get drawn instead. Samples live in toroidal storage, so
+// moving only samples the rows and columns that came into a level. That work
+// is spread over ticks, one row of a level at a time, and a move only shows
+// once every level has caught up with it. Levels hold a copy of the storage
+// from then, so the next move can start before the renderer reads them
+class Horizon
+{
+  public:
+    static constexpr int NUM_LEVELS = Config::HorizonLevels;
+    static constexpr int GRID_SIZE = Config::HorizonGridSize;
+    static constexpr int NUM_SAMPLES = GRID_SIZE + 1;
+
+    static_assert(GRID_SIZE % 4 == 0,
+                  "Levels are centered on every other sample of the next");
+
+    struct Sample
+    {
+        int16_t Height;
+        BlockType Block;
+    };
+
+    struct Level
+    {
+        // Distance between samples, in blocks
+        int Spacing = 0;
+        // Grid coordinates, in samples from the world origin, of the first
+        // sample on each axis
+        int OriginX = 0;
+        int OriginZ = 0;
+        // Grid coordinates of the quads covered by finer terrain, min
+        // inclusive and max exclusive
+        int HoleMinX = 0;
+        int HoleMinZ = 0;
+        int HoleMaxX = 0;
+        int HoleMaxZ = 0;
+        // Changes whenever the samples or the hole do, zero until the level
+        // was sampled for the first time
+        uint32_t Revision = 0;
+
+        // Offsets are in [0, NUM_SAMPLES) from the origin
+        const Sample& GetSample(int i, int j) const
+        {
+            return Samples[Wrap(OriginZ + j) * NUM_SAMPLES +
+                           Wrap(OriginX + i)];
+        }
+
+        // As the storage was at the last publish
+        std::vector<Sample> Samples{};
+    };
+
+    Horizon();
+
+    // Recenters the levels on the player, sampling what came into them
+    // within the scheduler's Horizon budget
+    void Update(WorldCoords playerPosition, const WorldGenerator& generator,
+                StreamingScheduler& scheduler);
+
+    const Level& GetLevel(size_t level) const { return m_Levels[level]; }
+
+  private:
+    static int Wrap(int gridCoord)
+    {
+        const int wrapped = gridCoord % NUM_SAMPLES;
+        return wrapped < 0 ? wrapped + NUM_SAMPLES : wrapped;
+    }
+
+    // Where a level is headed, the same fields as in Level
+    struct Target
+    {
+        int OriginX = 0;
+        int OriginZ = 0;
+        int HoleMinX = 0;
+        int HoleMinZ = 0;
+        int HoleMaxX = 0;
+        int HoleMaxZ = 0;
+    };
+
+    // What a row of a level's storage holds, the samples from OriginX on
+    // of grid row Z
+    struct StoredRow
+    {
+        int Z = 0;
+        int OriginX = 0;
+        bool Valid = false;
+    };
+
+    bool RowDone(size_t level, int gz) const;
+    void ResampleRow(size_t level, int gz, const WorldGenerator& generator);
+    void Publish();
+
+  private:
+    std::array<Level, NUM_LEVELS> m_Levels{};
+    std::array<Target, NUM_LEVELS> m_Targets{};
+    // The samples being brought up to the targets, laid out like a level's
+    std::array<std::vector<Sample>, NUM_LEVELS> m_Storage{};
+    std::array<std::array<StoredRow, NUM_SAMPLES>, NUM_LEVELS> m_Rows{};
+};
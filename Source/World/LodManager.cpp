@@ -0,0 +1,305 @@
+#include "LodManager.h"
+#include "ChunkUtils.h"
+#include "Core/DebugState.h"
+#include "StreamingScheduler.h"
+#include <algorithm>
+#include <cstdlib>
+
+extern DebugState g_DebugState;
+
+// Coordinates of the chunk that many levels coarser containing the given one
+static ChunkCoords Coarsen(ChunkCoords coords, int levels)
+{
+    return {coords.X >> levels, coords.Y >> levels, coords.Z >> levels};
+}
+
+static int ChebyshevDistance(ChunkCoords a, ChunkCoords b)
+{
+    const ChunkCoords diff = a - b;
+    return std::max({std::abs(diff.X), std::abs(diff.Y), std::abs(diff.Z)});
+}
+
+// Squared distance in blocks between the centers of the chunk and the
+// player's chunk
+static int64_t DistanceSq(ChunkCoords coords, int level, ChunkCoords player)
+{
+    const int64_t size = static_cast<int64_t>(CHUNK_DIMENSION) << level;
+    const auto axis = [size](int chunk, int playerChunk)
+    {
+        const int64_t diff = (chunk * size + size / 2) -
+                             (playerChunk * int64_t{CHUNK_DIMENSION} +
+                              CHUNK_DIMENSION / 2);
+        return diff * diff;
+    };
+    return axis(coords.X, player.X) + axis(coords.Y, player.Y) +
+           axis(coords.Z, player.Z);
+}
+
+struct CloserToPlayer
+{
+    ChunkCoords Player;
+
+    bool operator()(const Chunk* c1, const Chunk* c2) const
+    {
+        return DistanceSq(c1->GetCoords(), c1->GetLodLevel(), Player) <
+               DistanceSq(c2->GetCoords(), c2->GetLodLevel(), Player);
+    }
+};
+
+LodManager::~LodManager()
+{
+    FreeRetired();
+    for (Chunk* chunk : m_ByDistance)
+        delete chunk;
+}
+
+bool LodManager::InRing(ChunkCoords coords, int level) const
+{
+    // Only chunks that overlap the generated heights
+    const int size = CHUNK_DIMENSION << level;
+    if (coords.Y * size > WorldGenerator::MAX_HEIGHT ||
+        (coords.Y + 1) * size <= WorldGenerator::MIN_HEIGHT)
+        return false;
+
+    const int distance =
+        ChebyshevDistance(coords, Coarsen(m_PlayerChunk, level));
+    if (distance <= Config::LodRingRadius)
+        return false;
+    if (level == Config::LodLevels)
+        return distance <= Config::LodOuterRadius;
+    return ChebyshevDistance(Coarsen(coords, 1),
+                             Coarsen(m_PlayerChunk, level + 1)) <=
+           Config::LodRingRadius;
+}
+
+bool LodManager::DrawsRegularChunk(ChunkCoords coords) const
+{
+    if constexpr (Config::LodLevels == 0)
+        return true;
+    return ChebyshevDistance(Coarsen(coords, 1), Coarsen(m_PlayerChunk, 1)) <=
+           Config::LodRingRadius;
+}
+
+// A mesh built before all of its neighbors in the ring exist would have to
+// be rebuilt as soon as they load
+bool LodManager::NeighborsReady(const Chunk& chunk) const
+{
+    for (const BlockCoords normal : ChunkUtils::k_FaceNormals)
+    {
+        if (chunk.GetNeighbor(normal.X, normal.Y, normal.Z))
+            continue;
+        const ChunkCoords neighbor =
+            chunk.GetCoords() + ChunkCoords{normal.X, normal.Y, normal.Z};
+        if (InRing(neighbor, chunk.GetLodLevel()))
+            return false;
+    }
+    return true;
+}
+
+void LodManager::Update(ChunkCoords playerChunk,
+                        const WorldGenerator& generator,
+                        StreamingScheduler& scheduler)
+{
+    if (!m_HasPlayerChunk || playerChunk != m_PlayerChunk)
+    {
+        m_PlayerChunk = playerChunk;
+        m_HasPlayerChunk = true;
+        RetireChunks();
+        UpdateLoadList();
+        SortByDistance();
+        m_RenderListsDirty = true;
+    }
+
+    const bool loadsDone = m_LoadIndex == m_LoadList.size();
+
+    scheduler.BeginStage(StreamingStage::Lod);
+    while (!m_MeshesPending && m_LoadIndex < m_LoadList.size() &&
+           scheduler.NextUnit())
+    {
+        if (NumChunks() >= MaxChunks() && !FreeFarthestRetired())
+            break;
+        LoadChunk(m_LoadList[m_LoadIndex++], generator);
+    }
+    scheduler.EndStage();
+
+    // Only once everything that replaces them is drawn
+    if (loadsDone && !m_MeshesPending && !m_Retired.empty())
+    {
+        FreeRetired();
+        m_RenderListsDirty = true;
+    }
+
+    if (m_RenderListsDirty)
+        UpdateRenderLists();
+}
+
+void LodManager::BuildMeshes(MeshCache* cache, StreamingScheduler& scheduler)
+{
+    m_MeshesPending = false;
+    for (Chunk* chunk : m_ByDistance)
+    {
+        if (!chunk->NeedsRebuild() || !NeighborsReady(*chunk))
+            continue;
+        if (!scheduler.NextUnit())
+        {
+            m_MeshesPending = true;
+            break;
+        }
+        if (chunk->BuildMesh(cache))
+            g_DebugState.CachedMeshes++;
+        chunk->UploadMesh();
+        m_RenderListsDirty = true;
+    }
+}
+
+void LodManager::UpdateLoadList()
+{
+    m_LoadList.clear();
+    m_LoadIndex = 0;
+
+    for (int level = 1; level <= Config::LodLevels; level++)
+    {
+        // Children of the chunks within the radius of the player's parent
+        // chunk are at most 2 * radius + 1 away from the player's chunk
+        const int reach = level == Config::LodLevels
+                              ? Config::LodOuterRadius
+                              : 2 * Config::LodRingRadius + 1;
+        const ChunkCoords center = Coarsen(m_PlayerChunk, level);
+        const auto& chunks = m_Chunks[level - 1];
+        for (int y = -reach; y <= reach; y++)
+        {
+            for (int z = -reach; z <= reach; z++)
+            {
+                for (int x = -reach; x <= reach; x++)
+                {
+                    const ChunkCoords coords = center + ChunkCoords{x, y, z};
+                    if (InRing(coords, level) && !chunks.contains(coords))
+                        m_LoadList.push_back({coords, level});
+                }
+            }
+        }
+    }
+
+    std::sort(m_LoadList.begin(), m_LoadList.end(),
+              [this](const LodCoords& a, const LodCoords& b)
+              {
+                  return DistanceSq(a.Coords, a.Level, m_PlayerChunk) <
+                         DistanceSq(b.Coords, b.Level, m_PlayerChunk);
+              });
+}
+
+void LodManager::RetireChunks()
+{
+    for (auto it = m_ByDistance.begin(); it != m_ByDistance.end();)
+    {
+        Chunk* const chunk = *it;
+        const int level = chunk->GetLodLevel();
+        if (InRing(chunk->GetCoords(), level))
+        {
+            it++;
+            continue;
+        }
+
+        // The neighbors that stay get faces toward it, the chunk itself is
+        // never meshed again
+        for (const BlockCoords normal : ChunkUtils::k_FaceNormals)
+        {
+            if (Chunk* neighbor =
+                    chunk->GetNeighbor(normal.X, normal.Y, normal.Z))
+                neighbor->TriggerRebuild();
+        }
+        chunk->UnlinkNeighbors();
+        chunk->DiscardRebuild();
+        m_Chunks[level - 1].erase(chunk->GetCoords());
+        m_Retired.push_back(chunk);
+        it = m_ByDistance.erase(it);
+    }
+}
+
+void LodManager::FreeRetired()
+{
+    for (Chunk* chunk : m_Retired)
+        delete chunk;
+    m_Retired.clear();
+}
+
+bool LodManager::FreeFarthestRetired()
+{
+    if (m_Retired.empty())
+        return false;
+
+    const auto farthest = std::max_element(
+        m_Retired.begin(), m_Retired.end(), CloserToPlayer{m_PlayerChunk});
+    delete *farthest;
+    *farthest = m_Retired.back();
+    m_Retired.pop_back();
+    m_RenderListsDirty = true;
+    return true;
+}
+
+void LodManager::LoadChunk(LodCoords lodCoords,
+                           const WorldGenerator& generator)
+{
+    auto& chunks = m_Chunks[lodCoords.Level - 1];
+    Chunk* const chunk =
+        new Chunk{lodCoords.Coords, static_cast<uint8_t>(lodCoords.Level)};
+
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                if (dx == 0 && dy == 0 && dz == 0)
+                    continue;
+                const ChunkCoords neighborCoords =
+                    lodCoords.Coords + ChunkCoords{dx, dy, dz};
+                if (auto it = chunks.find(neighborCoords); it != chunks.end())
+                    chunk->LinkNeighbor(it->second,
+                                        ChunkUtils::NeighborIndex(dx, dy, dz));
+            }
+        }
+    }
+
+    generator.GenerateLodChunk(*chunk);
+    for (const BlockCoords normal : ChunkUtils::k_FaceNormals)
+    {
+        if (Chunk* neighbor = chunk->GetNeighbor(normal.X, normal.Y, normal.Z))
+            neighbor->TriggerRebuild();
+    }
+
+    chunks[lodCoords.Coords] = chunk;
+    const auto it =
+        std::upper_bound(m_ByDistance.begin(), m_ByDistance.end(), chunk,
+                         CloserToPlayer{m_PlayerChunk});
+    m_ByDistance.insert(it, chunk);
+}
+
+void LodManager::SortByDistance()
+{
+    std::sort(m_ByDistance.begin(), m_ByDistance.end(),
+              CloserToPlayer{m_PlayerChunk});
+}
+
+void LodManager::UpdateRenderLists()
+{
+    m_RenderListsDirty = false;
+    m_RenderList.clear();
+    m_WaterRenderList.clear();
+
+    std::vector<const Chunk*> drawn{m_ByDistance.begin(), m_ByDistance.end()};
+    if (!m_Retired.empty())
+    {
+        drawn.insert(drawn.end(), m_Retired.begin(), m_Retired.end());
+        std::sort(drawn.begin(), drawn.end(), CloserToPlayer{m_PlayerChunk});
+    }
+
+    for (const Chunk* chunk : drawn)
+    {
+        const ChunkMesh& mesh = chunk->GetMesh();
+        if (mesh.NumOpaqueVertices() > 0)
+            m_RenderList.push_back(chunk);
+        if (mesh.NumTransparentVertices() > 0)
+            m_WaterRenderList.push_back(chunk);
+    }
+}
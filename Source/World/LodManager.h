@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Chunk.h"
+#include "Core/Config.h"
+#include "World/Coordinates.h"
+#include "WorldGenerator.h"
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+class MeshCache;
+class StreamingScheduler;
+
+// Keeps the chunks of every LOD level above zero generated and meshed inside
+// that level's ring around the player. Level L's ring is every chunk whose
+// parent at level L + 1 is within Config::LodRingRadius of the player's, minus
+// the ones within that radius of the player's chunk at level L, which level
+// L - 1 covers. Faces toward neighbors that aren't loaded get meshed like
+// toward air, which seals the borders between levels
+class LodManager
+{
+  public:
+    LodManager() = default;
+    ~LodManager();
+
+    LodManager(const LodManager&) = delete;
+    LodManager& operator=(const LodManager&) = delete;
+
+    // Moves the rings along with the player, then generates the missing
+    // chunks, nearest first, within the scheduler's LOD budget. Chunks that
+    // left their ring keep getting drawn until their replacements are done
+    void Update(ChunkCoords playerChunk, const WorldGenerator& generator,
+                StreamingScheduler& scheduler);
+
+    // Meshes and uploads the chunks whose neighbors are ready, nearest first.
+    // Runs inside the scheduler's Mesh stage, after the regular chunks, so
+    // that both share one budget
+    void BuildMeshes(MeshCache* cache, StreamingScheduler& scheduler);
+
+    // Whether a regular chunk is inside the finest ring, everything outside
+    // of it is drawn by the LOD levels
+    bool DrawsRegularChunk(ChunkCoords coords) const;
+
+    // Both sorted nearest first
+    const std::vector<const Chunk*>& GetRenderList() const
+    {
+        return m_RenderList;
+    }
+    const std::vector<const Chunk*>& GetWaterRenderList() const
+    {
+        return m_WaterRenderList;
+    }
+
+    size_t NumChunks() const { return m_ByDistance.size() + m_Retired.size(); }
+
+    // Upper bound on the chunks alive at once, 1269 with the default config,
+    // at about 68 KiB of blocks and occupancy each. Exactly the size of the
+    // rings, so retired chunks only live on in slots that the rings don't
+    // use yet. Once those run out, every new chunk drops the farthest retired
+    // one early
+    static constexpr size_t MaxChunks()
+    {
+        size_t total = 0;
+        for (int level = 1; level <= Config::LodLevels; level++)
+            total += ColumnsAtLevel(level) * LayersAtLevel(level);
+        return total;
+    }
+
+  private:
+    struct LodCoords
+    {
+        ChunkCoords Coords;
+        int Level;
+    };
+
+    static constexpr size_t ColumnsAtLevel(int level)
+    {
+        constexpr size_t hole = (2 * Config::LodRingRadius + 1) *
+                                (2 * Config::LodRingRadius + 1);
+        const size_t outer = level == Config::LodLevels
+                                 ? 2 * Config::LodOuterRadius + 1
+                                 : 2 * (2 * Config::LodRingRadius + 1);
+        return outer * outer - hole;
+    }
+
+    // Chunks per column that overlap the generated heights
+    static constexpr size_t LayersAtLevel(int level)
+    {
+        const int size = CHUNK_DIMENSION << level;
+        const auto floorDiv = [](int a, int b)
+        { return a >= 0 ? a / b : (a - b + 1) / b; };
+        return static_cast<size_t>(
+            floorDiv(WorldGenerator::MAX_HEIGHT, size) -
+            floorDiv(WorldGenerator::MIN_HEIGHT, size) + 1);
+    }
+
+    static_assert(Config::LodOuterRadius >= Config::LodRingRadius,
+                  "The coarsest ring can't be smaller than its hole");
+
+    bool InRing(ChunkCoords coords, int level) const;
+    bool NeighborsReady(const Chunk& chunk) const;
+
+    void UpdateLoadList();
+    void RetireChunks();
+    void FreeRetired();
+    // Returns false if there were no retired chunks
+    bool FreeFarthestRetired();
+    void LoadChunk(LodCoords lodCoords, const WorldGenerator& generator);
+    void SortByDistance();
+    void UpdateRenderLists();
+
+  private:
+    // Indexed by level - 1
+    std::array<std::unordered_map<ChunkCoords, Chunk*>, Config::LodLevels>
+        m_Chunks{};
+    // Every loaded chunk of all levels, nearest first
+    std::vector<Chunk*> m_ByDistance{};
+    // Out of their ring and unlinked, only kept for their meshes
+    std::vector<Chunk*> m_Retired{};
+    // Missing chunks of the rings, nearest first
+    std::vector<LodCoords> m_LoadList{};
+    size_t m_LoadIndex = 0;
+
+    std::vector<const Chunk*> m_RenderList{};
+    std::vector<const Chunk*> m_WaterRenderList{};
+
+    ChunkCoords m_PlayerChunk{};
+    bool m_HasPlayerChunk = false;
+    bool m_RenderListsDirty = false;
+    // Chunks were left unmeshed by the last BuildMeshes(), which holds back
+    // loading more
+    bool m_MeshesPending = false;
+};
@@ -0,0 +1,189 @@
+#include "MeshBenchmark.h"
+#include "Chunk.h"
+#include "MeshBuilder.h"
+#include "ChunkUtils.h"
+#include "Core/Logger.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <span>
+
+static constexpr int k_Iterations = 100;
+static constexpr int k_SeaLevel = 14;
+static constexpr int k_TreeSpacing = 7;
+
+enum class Scenario : uint8_t
+{
+    Surface,
+    Underground,
+    Forest,
+    Count
+};
+
+static constexpr std::array<const char*, static_cast<size_t>(Scenario::Count)>
+    k_ScenarioNames{"Surface", "Underground", "Forest"};
+
+static int SurfaceHeight(int x, int z)
+{
+    return 16 + static_cast<int>(6.0f * std::sin(static_cast<float>(x) * 0.2f) *
+                                 std::cos(static_cast<float>(z) * 0.15f));
+}
+
+// Roughly a third of the points on a grid get a tree
+static bool IsTreeRoot(int x, int z)
+{
+    if ((x % k_TreeSpacing + k_TreeSpacing) % k_TreeSpacing != 0 ||
+        (z % k_TreeSpacing + k_TreeSpacing) % k_TreeSpacing != 0)
+        return false;
+    const uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^
+                          static_cast<uint32_t>(z) * 19349663u;
+    return (hash >> 4) % 3 == 0;
+}
+
+static BlockType TreeBlock(int x, int y, int z)
+{
+    for (int dz = -2; dz <= 2; dz++)
+    {
+        for (int dx = -2; dx <= 2; dx++)
+        {
+            if (!IsTreeRoot(x + dx, z + dz))
+                continue;
+
+            const int base = SurfaceHeight(x + dx, z + dz);
+            if (dx == 0 && dz == 0 && y > base && y <= base + 5)
+                return BlockType::Log;
+            if (y >= base + 4 && y <= base + 6)
+                return BlockType::Leaves;
+        }
+    }
+    return BlockType::Air;
+}
+
+static BlockType ScenarioBlock(Scenario scenario, int x, int y, int z)
+{
+    if (scenario == Scenario::Underground)
+    {
+        // Solid stone with winding tunnels through it
+        const float cave = std::sin(static_cast<float>(x) * 0.3f) +
+                           std::sin(static_cast<float>(y) * 0.25f) +
+                           std::sin(static_cast<float>(z) * 0.35f);
+        return cave > 1.5f ? BlockType::Air : BlockType::Stone;
+    }
+
+    const int height = SurfaceHeight(x, z);
+    if (y < height - 3)
+        return BlockType::Stone;
+    if (y < height)
+        return BlockType::Dirt;
+    if (y == height)
+        return height <= k_SeaLevel ? BlockType::Sand : BlockType::Grass;
+    if (y <= k_SeaLevel)
+        return BlockType::Water;
+    if (scenario == Scenario::Forest)
+        return TreeBlock(x, y, z);
+    return BlockType::Air;
+}
+
+static void FillChunk(Chunk& chunk, Scenario scenario)
+{
+    const ChunkCoords origin = chunk.GetCoords() * CHUNK_DIMENSION;
+    for (uint8_t y = 0; y < CHUNK_DIMENSION; y++)
+    {
+        for (uint8_t z = 0; z < CHUNK_DIMENSION; z++)
+        {
+            for (uint8_t x = 0; x < CHUNK_DIMENSION; x++)
+            {
+                chunk.SetBlock(ScenarioBlock(scenario, origin.X + x,
+                                             origin.Y + y, origin.Z + z),
+                               x, y, z);
+            }
+        }
+    }
+}
+
+static float TimeKernel(const Chunk& chunk, MeshBuilder& builder,
+                        MeshingKernel kernel)
+{
+    using namespace std::chrono;
+
+    const high_resolution_clock::time_point start =
+        high_resolution_clock::now();
+    for (int i = 0; i < k_Iterations; i++)
+    {
+        builder.Build(chunk, MeshBuilder::ALL_SECTIONS, kernel);
+    }
+    const high_resolution_clock::time_point end = high_resolution_clock::now();
+    return duration<float, std::micro>(end - start).count() /
+           static_cast<float>(k_Iterations);
+}
+
+static bool SameVertices(std::span<const ChunkVertex> a,
+                         std::span<const ChunkVertex> b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](ChunkVertex lhs, ChunkVertex rhs)
+                      { return lhs.Get() == rhs.Get(); });
+}
+
+static bool SameMeshes(const MeshBuilder& a, const MeshBuilder& b)
+{
+    for (size_t i = 0; i < MeshBuilder::NUM_FACES; i++)
+    {
+        const BlockFace face = static_cast<BlockFace>(i);
+        if (!SameVertices(a.GetOpaque(face), b.GetOpaque(face)) ||
+            !SameVertices(a.GetTransparent(face), b.GetTransparent(face)))
+            return false;
+    }
+    return true;
+}
+
+static void RunScenario(Scenario scenario)
+{
+    Chunk* const center = new Chunk{ChunkCoords{
+        0, scenario == Scenario::Underground ? -4 : 0, 0}};
+    FillChunk(*center, scenario);
+
+    std::array<Chunk*, static_cast<size_t>(BlockFace::Count)> neighbors{};
+    for (size_t face = 0; face < neighbors.size(); face++)
+    {
+        const BlockCoords normal = ChunkUtils::k_FaceNormals[face];
+        neighbors[face] = new Chunk{center->GetCoords() +
+                                    ChunkCoords{normal.X, normal.Y, normal.Z}};
+        center->LinkNeighbor(
+            neighbors[face],
+            ChunkUtils::NeighborIndex(normal.X, normal.Y, normal.Z));
+        FillChunk(*neighbors[face], scenario);
+    }
+
+    MeshBuilder perBlockBuilder{};
+    MeshBuilder bitwiseBuilder{};
+    const float perBlockMicros =
+        TimeKernel(*center, perBlockBuilder, MeshingKernel::PerBlock);
+    const float bitwiseMicros =
+        TimeKernel(*center, bitwiseBuilder, MeshingKernel::Bitwise);
+
+    const bool match = SameMeshes(perBlockBuilder, bitwiseBuilder);
+    const size_t numVertices = bitwiseBuilder.NumVertices();
+    const float speedup = perBlockMicros / bitwiseMicros;
+
+    const char* const name = k_ScenarioNames[static_cast<size_t>(scenario)];
+    LOG_INFO("{} ({} vertices): per block {:.1f} us, bitwise {:.1f} us, "
+             "{:.2f}x",
+             name, numVertices, perBlockMicros, bitwiseMicros, speedup);
+    if (!match)
+        LOG_WARN("{}: meshing kernels disagree", name);
+
+    for (Chunk* neighbor : neighbors)
+        delete neighbor;
+    delete center;
+}
+
+void MeshBenchmark::Run()
+{
+    LOG_INFO("Mesh benchmark, average of {} full chunk builds:", k_Iterations);
+    for (size_t i = 0; i < static_cast<size_t>(Scenario::Count); i++)
+    {
+        RunScenario(static_cast<Scenario>(i));
+    }
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+namespace MeshBenchmark
+{
+// Meshes a typical surface, underground and forest chunk with both
+// MeshingKernels and logs how long each took, and whether they agree. The
+// chunks are generated on the side with their six face neighbors, nothing is
+// added to the world and no GL context is needed
+void Run();
+} // namespace MeshBenchmark
@@ -0,0 +1,964 @@
+#include "MeshBuilder.h"
+#include "Chunk.h"
+#include "ChunkUtils.h"
+#include "Core/Common.h"
+#include <bit>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+static constexpr std::array<
+    std::array<ChunkVertex, ChunkVertex::VERTICES_PER_FACE>,
+    static_cast<size_t>(BlockFace::Count)>
+    k_FaceVertices{{// Front
+                    {{{0, 0, 1, 0, 0, BlockFace::PosZ},
+                      {1, 1, 1, 1, 1, BlockFace::PosZ},
+                      {0, 1, 1, 0, 1, BlockFace::PosZ},
+                      {0, 0, 1, 0, 0, BlockFace::PosZ},
+                      {1, 0, 1, 1, 0, BlockFace::PosZ},
+                      {1, 1, 1, 1, 1, BlockFace::PosZ}}},
+                    // Back
+                    {{{1, 0, 0, 0, 0, BlockFace::NegZ},
+                      {0, 1, 0, 1, 1, BlockFace::NegZ},
+                      {1, 1, 0, 0, 1, BlockFace::NegZ},
+                      {1, 0, 0, 0, 0, BlockFace::NegZ},
+                      {0, 0, 0, 1, 0, BlockFace::NegZ},
+                      {0, 1, 0, 1, 1, BlockFace::NegZ}}},
+                    // Left
+                    {{{0, 0, 0, 0, 0, BlockFace::NegX},
+                      {0, 1, 1, 1, 1, BlockFace::NegX},
+                      {0, 1, 0, 0, 1, BlockFace::NegX},
+                      {0, 0, 0, 0, 0, BlockFace::NegX},
+                      {0, 0, 1, 1, 0, BlockFace::NegX},
+                      {0, 1, 1, 1, 1, BlockFace::NegX}}},
+                    // Right
+                    {{{1, 0, 1, 0, 0, BlockFace::PosX},
+                      {1, 1, 0, 1, 1, BlockFace::PosX},
+                      {1, 1, 1, 0, 1, BlockFace::PosX},
+                      {1, 0, 1, 0, 0, BlockFace::PosX},
+                      {1, 0, 0, 1, 0, BlockFace::PosX},
+                      {1, 1, 0, 1, 1, BlockFace::PosX}}},
+                    // Top
+                    {{{0, 1, 1, 0, 0, BlockFace::PosY},
+                      {1, 1, 0, 1, 1, BlockFace::PosY},
+                      {0, 1, 0, 0, 1, BlockFace::PosY},
+                      {0, 1, 1, 0, 0, BlockFace::PosY},
+                      {1, 1, 1, 1, 0, BlockFace::PosY},
+                      {1, 1, 0, 1, 1, BlockFace::PosY}}},
+                    // Bottom
+                    {{{0, 0, 0, 0, 0, BlockFace::NegY},
+                      {1, 0, 1, 1, 1, BlockFace::NegY},
+                      {0, 0, 1, 0, 1, BlockFace::NegY},
+                      {0, 0, 0, 0, 0, BlockFace::NegY},
+                      {1, 0, 0, 1, 0, BlockFace::NegY},
+                      {1, 0, 1, 1, 1, BlockFace::NegY}}}}};
+
+static constexpr bool InChunkBounds(int x, int y, int z)
+{
+    return x >= 0 && x < CHUNK_DIMENSION && y >= 0 && y < CHUNK_DIMENSION &&
+           z >= 0 && z < CHUNK_DIMENSION;
+}
+
+static BlockType GetBlock(const Chunk& chunk, BlockCoords offset)
+{
+    if (ChunkUtils::IsLocal(offset))
+    {
+        return chunk.GetBlock(offset.X, offset.Y, offset.Z);
+    }
+    else
+    {
+        // Offsets never reach further than the adjacent chunks
+        const ChunkCoords chunkOffset = static_cast<ChunkCoords>(offset);
+        const Chunk* const neighbor =
+            chunk.GetNeighbor(chunkOffset.X, chunkOffset.Y, chunkOffset.Z);
+        if (!neighbor)
+            return BlockType::Air;
+        const LocalBlockCoords local = static_cast<LocalBlockCoords>(offset);
+        return neighbor->GetBlock(local.X, local.Y, local.Z);
+    }
+}
+
+// Ambient occlusion is looked up from a 27 bit mask of which blocks around a
+// block are opaque. Each row along X of the neighborhood is three adjacent
+// bits, so it can be copied straight out of the padded occupancy rows
+static constexpr int NeighborhoodBit(int dx, int dy, int dz)
+{
+    return (dx + 1) + 3 * (dz + 1) + 9 * (dy + 1);
+}
+
+// A face's ambient occlusion only depends on the 8 blocks around the one
+// right across it
+static constexpr size_t k_NumPlaneBlocks = 8;
+
+static constexpr std::array<std::array<uint8_t, k_NumPlaneBlocks>,
+                            MeshBuilder::NUM_FACES>
+    k_FacePlaneBits = []
+{
+    std::array<std::array<uint8_t, k_NumPlaneBlocks>, MeshBuilder::NUM_FACES>
+        planeBits{};
+    for (size_t face = 0; face < MeshBuilder::NUM_FACES; face++)
+    {
+        const BlockCoords normal = ChunkUtils::k_FaceNormals[face];
+        size_t slot = 0;
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dz = -1; dz <= 1; dz++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    const bool inPlane = (normal.X == 0 || dx == normal.X) &&
+                                         (normal.Y == 0 || dy == normal.Y) &&
+                                         (normal.Z == 0 || dz == normal.Z);
+                    const bool across =
+                        dx == normal.X && dy == normal.Y && dz == normal.Z;
+                    if (inPlane && !across)
+                        planeBits[face][slot++] = static_cast<uint8_t>(
+                            NeighborhoodBit(dx, dy, dz));
+                }
+            }
+        }
+    }
+    return planeBits;
+}();
+
+// Two bits of ambient occlusion for each of the six vertices of a face, in
+// vertex order, for every combination of the face's plane blocks. A vertex
+// looks at the two blocks along the edges next to its corner and the one
+// diagonally across it
+static constexpr std::array<std::array<uint16_t, 1u << k_NumPlaneBlocks>,
+                            MeshBuilder::NUM_FACES>
+    k_FaceOcclusion = []
+{
+    std::array<std::array<uint16_t, 1u << k_NumPlaneBlocks>,
+               MeshBuilder::NUM_FACES>
+        occlusion{};
+    for (size_t face = 0; face < MeshBuilder::NUM_FACES; face++)
+    {
+        const BlockCoords normal = ChunkUtils::k_FaceNormals[face];
+        for (uint32_t plane = 0; plane < (1u << k_NumPlaneBlocks); plane++)
+        {
+            uint32_t neighborhood = 0;
+            for (size_t slot = 0; slot < k_NumPlaneBlocks; slot++)
+            {
+                if (plane & (1u << slot))
+                    neighborhood |= 1u << k_FacePlaneBits[face][slot];
+            }
+            auto opaque = [&](int dx, int dy, int dz) -> int
+            { return (neighborhood >> NeighborhoodBit(dx, dy, dz)) & 1u; };
+
+            uint16_t packed = 0;
+            for (size_t i = 0; i < ChunkVertex::VERTICES_PER_FACE; i++)
+            {
+                // Corner of the vertex, -1 or 1 along both axes of the face
+                const LocalBlockCoords corner =
+                    k_FaceVertices[face][i].GetLocalCoords();
+                const int cx = normal.X != 0 ? 0 : corner.X * 2 - 1;
+                const int cy = normal.Y != 0 ? 0 : corner.Y * 2 - 1;
+                const int cz = normal.Z != 0 ? 0 : corner.Z * 2 - 1;
+
+                // The corner offset along just one of the two axes
+                const int edge1 =
+                    cx != 0 ? opaque(normal.X + cx, normal.Y, normal.Z)
+                            : opaque(normal.X, normal.Y + cy, normal.Z);
+                const int edge2 =
+                    cz != 0 ? opaque(normal.X, normal.Y, normal.Z + cz)
+                            : opaque(normal.X, normal.Y + cy, normal.Z);
+                const int diagonal = opaque(normal.X + cx, normal.Y + cy,
+                                            normal.Z + cz);
+                const int factor =
+                    edge1 && edge2 ? 0 : 3 - (edge1 + edge2 + diagonal);
+                packed |= static_cast<uint16_t>(factor << (2 * i));
+            }
+            occlusion[face][plane] = packed;
+        }
+    }
+    return occlusion;
+}();
+
+// The face's plane blocks out of a block's neighborhood, indexes
+// k_FaceOcclusion
+static uint32_t PlaneIndex(size_t face, uint32_t neighborhood)
+{
+    uint32_t plane = 0;
+    for (size_t slot = 0; slot < k_NumPlaneBlocks; slot++)
+        plane |= ((neighborhood >> k_FacePlaneBits[face][slot]) & 1u) << slot;
+    return plane;
+}
+
+// Column along X of the row at (y, z), air if the chunk isn't loaded
+static uint32_t ColumnXOrAir(const Chunk* chunk, OccupancyClass occupancyClass,
+                             int y, int z)
+{
+    if (!chunk)
+        return 0;
+    return chunk->GetOccupancy().ColumnX(occupancyClass,
+                                         static_cast<uint8_t>(y),
+                                         static_cast<uint8_t>(z));
+}
+
+// Chunk offset along one axis of a coordinate that may be one past the chunk
+static int ChunkOffset(int coord)
+{
+    if (coord < 0)
+        return -1;
+    return coord >= CHUNK_DIMENSION ? 1 : 0;
+}
+
+// Column along X of the row at (y, z). The row can be one past the chunk on Y
+// or Z, in which case it's read from the neighbor there
+static uint32_t RowX(const Chunk& chunk, OccupancyClass occupancyClass, int y,
+                     int z)
+{
+    if (y < 0 || y >= CHUNK_DIMENSION)
+        return ColumnXOrAir(chunk.GetNeighbor(0, y < 0 ? -1 : 1, 0),
+                            occupancyClass,
+                            (y + CHUNK_DIMENSION) % CHUNK_DIMENSION, z);
+    if (z < 0 || z >= CHUNK_DIMENSION)
+        return ColumnXOrAir(chunk.GetNeighbor(0, 0, z < 0 ? -1 : 1),
+                            occupancyClass, y,
+                            (z + CHUNK_DIMENSION) % CHUNK_DIMENSION);
+    return ColumnXOrAir(&chunk, occupancyClass, y, z);
+}
+
+// For each block in the row at (y, z), whether its neighbor across each face is
+// of the class, indexed by BlockFace. Unloaded neighbors are air
+static std::array<uint32_t, MeshBuilder::NUM_FACES>
+NeighborRows(const Chunk& chunk, OccupancyClass occupancyClass, int y, int z)
+{
+    const uint32_t row = RowX(chunk, occupancyClass, y, z);
+    // Bit 0 of the row to the right and bit 31 of the one to the left are
+    // the blocks right across the chunk border
+    const uint32_t leftRow =
+        ColumnXOrAir(chunk.GetNeighbor(-1, 0, 0), occupancyClass, y, z);
+    const uint32_t rightRow =
+        ColumnXOrAir(chunk.GetNeighbor(1, 0, 0), occupancyClass, y, z);
+
+    std::array<uint32_t, MeshBuilder::NUM_FACES> rows{};
+    rows[static_cast<size_t>(BlockFace::PosZ)] =
+        RowX(chunk, occupancyClass, y, z + 1);
+    rows[static_cast<size_t>(BlockFace::NegZ)] =
+        RowX(chunk, occupancyClass, y, z - 1);
+    rows[static_cast<size_t>(BlockFace::NegX)] = (row << 1) | (leftRow >> 31);
+    rows[static_cast<size_t>(BlockFace::PosX)] = (row >> 1) | (rightRow << 31);
+    rows[static_cast<size_t>(BlockFace::PosY)] =
+        RowX(chunk, occupancyClass, y + 1, z);
+    rows[static_cast<size_t>(BlockFace::NegY)] =
+        RowX(chunk, occupancyClass, y - 1, z);
+    return rows;
+}
+
+// At most one face in each direction per block
+static constexpr size_t k_MaxScratchBytes =
+    CHUNK_VOLUME_U * ChunkVertex::VERTICES_PER_FACE * sizeof(ChunkVertex);
+
+static std::span<const ChunkVertex> ScratchVertices(const ArenaAllocator& arena)
+{
+    return {static_cast<const ChunkVertex*>(arena.GetBase()),
+            arena.GetMarker() / sizeof(ChunkVertex)};
+}
+
+// Copies the vertices of every direction one after the other, which is the
+// order of the ranges
+static void GatherScratch(
+    const std::array<ArenaAllocator, MeshBuilder::NUM_FACES>& arenas,
+    std::vector<ChunkVertex>& vertices)
+{
+    size_t numVertices = 0;
+    for (const ArenaAllocator& arena : arenas)
+        numVertices += ScratchVertices(arena).size();
+
+    // Sized up front, so this is the only allocation
+    vertices.clear();
+    vertices.reserve(numVertices);
+    for (const ArenaAllocator& arena : arenas)
+    {
+        const std::span<const ChunkVertex> scratch = ScratchVertices(arena);
+        vertices.insert(vertices.end(), scratch.begin(), scratch.end());
+    }
+}
+
+// A point of the block grid, from 0 to CHUNK_DIMENSION on each axis
+using GridPoint = std::array<int, 3>;
+
+// X first, then Z, then Y, like the block index
+static size_t ShadowCornerIndex(const GridPoint& point)
+{
+    constexpr size_t dimension = CHUNK_DIMENSION_U + 1;
+    return static_cast<size_t>(point[0]) +
+           dimension * (static_cast<size_t>(point[2]) +
+                        dimension * static_cast<size_t>(point[1]));
+}
+
+// Around a rectangle of faces in the winding of the unit face's triangles,
+// (0, 1, 2) and (0, 4, 1)
+static std::array<GridPoint, 4> QuadCorners(BlockFace face,
+                                            LocalBlockCoords offset,
+                                            LocalBlockCoords size)
+{
+    const auto& unit = k_FaceVertices[static_cast<size_t>(face)];
+    std::array<GridPoint, 4> corners;
+    const std::array<size_t, 4> order{0, 4, 1, 2};
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const LocalBlockCoords corner = unit[order[i]].GetLocalCoords();
+        corners[i] = {offset.X + corner.X * size.X,
+                      offset.Y + corner.Y * size.Y,
+                      offset.Z + corner.Z * size.Z};
+    }
+    return corners;
+}
+
+static int NormalAxis(BlockFace face)
+{
+    const BlockCoords normal =
+        ChunkUtils::k_FaceNormals[static_cast<size_t>(face)];
+    return normal.X != 0 ? 0 : (normal.Y != 0 ? 1 : 2);
+}
+
+// The one axis the side of a rectangle runs along
+static int SideAxis(const GridPoint& from, const GridPoint& to)
+{
+    return from[0] != to[0] ? 0 : (from[1] != to[1] ? 1 : 2);
+}
+
+// The depth shader repeats a texture once per block over a merged face, so
+// the faces of opaque blocks can take any texture that's opaque all over
+static constexpr BlockType k_MergedShadowBlock = BlockType::Stone;
+
+MeshBuilder::MeshBuilder()
+{
+    for (size_t face = 0; face < NUM_FACES; face++)
+    {
+        m_Opaque[face].Init(0, k_MaxScratchBytes);
+        m_Transparent[face].Init(0, k_MaxScratchBytes);
+        m_Shadow[face].Init(0, k_MaxScratchBytes);
+    }
+}
+
+void MeshBuilder::Build(const Chunk& chunk, uint8_t sections,
+                        MeshingKernel kernel)
+{
+    for (size_t face = 0; face < NUM_FACES; face++)
+    {
+        m_Opaque[face].Clear();
+        m_Transparent[face].Clear();
+    }
+
+    if (sections != 0)
+    {
+        const int lowest = std::countr_zero(sections);
+        const int highest =
+            static_cast<int>(NUM_SECTIONS) - 1 - std::countl_zero(sections);
+        PadOpaqueRows(chunk, lowest * SECTION_HEIGHT - 1,
+                      (highest + 1) * SECTION_HEIGHT);
+    }
+
+    for (size_t section = 0; section < NUM_SECTIONS; section++)
+    {
+        std::array<size_t, NUM_FACES> opaqueStarts{};
+        std::array<size_t, NUM_FACES> transparentStarts{};
+        for (size_t face = 0; face < NUM_FACES; face++)
+        {
+            opaqueStarts[face] = ScratchVertices(m_Opaque[face]).size();
+            transparentStarts[face] =
+                ScratchVertices(m_Transparent[face]).size();
+        }
+
+        if (sections & (1u << section))
+        {
+            if (kernel == MeshingKernel::Bitwise)
+                BuildSectionBitwise(chunk, section);
+            else
+                BuildSectionPerBlock(chunk, section);
+        }
+
+        for (size_t face = 0; face < NUM_FACES; face++)
+        {
+            const size_t range =
+                RangeIndex(static_cast<BlockFace>(face), section);
+            m_OpaqueCounts[range] = static_cast<uint32_t>(
+                ScratchVertices(m_Opaque[face]).size() - opaqueStarts[face]);
+            m_TransparentCounts[range] = static_cast<uint32_t>(
+                ScratchVertices(m_Transparent[face]).size() -
+                transparentStarts[face]);
+        }
+    }
+}
+
+std::span<const ChunkVertex> MeshBuilder::GetOpaque(BlockFace face) const
+{
+    return ScratchVertices(m_Opaque[static_cast<size_t>(face)]);
+}
+
+std::span<const ChunkVertex> MeshBuilder::GetTransparent(BlockFace face) const
+{
+    return ScratchVertices(m_Transparent[static_cast<size_t>(face)]);
+}
+
+size_t MeshBuilder::NumVertices() const
+{
+    size_t numVertices = 0;
+    for (size_t face = 0; face < NUM_FACES; face++)
+    {
+        numVertices += ScratchVertices(m_Opaque[face]).size() +
+                       ScratchVertices(m_Transparent[face]).size();
+    }
+    return numVertices;
+}
+
+void MeshBuilder::GatherOpaque(std::vector<ChunkVertex>& vertices) const
+{
+    GatherScratch(m_Opaque, vertices);
+}
+
+void MeshBuilder::GatherTransparent(std::vector<ChunkVertex>& vertices) const
+{
+    GatherScratch(m_Transparent, vertices);
+}
+
+// What the shadow mesh takes from a row of blocks along X
+struct ShadowRow
+{
+    uint32_t Opaque = 0;
+    uint32_t Leaves = 0;
+    // Blocks with holes in their texture besides leaves, which keep their
+    // own texture for the alpha test
+    uint32_t OtherCutouts = 0;
+    // The blocks whose face in each direction can be lit. Faces pressed
+    // against an opaque block never are, the block's own face right there is
+    // in the way
+    std::array<uint32_t, MeshBuilder::NUM_FACES> Lit{};
+};
+
+// False if none of the row's blocks cast shadows
+static bool ReadShadowRow(const Chunk& chunk, uint8_t y, uint8_t z,
+                          ShadowRow& row)
+{
+    const ChunkOccupancy& occupancy = chunk.GetOccupancy();
+    if (occupancy.ColumnX(OccupancyClass::NonAir, y, z) == 0)
+        return false;
+
+    row.Opaque = occupancy.ColumnX(OccupancyClass::Opaque, y, z);
+    row.Leaves = 0;
+    row.OtherCutouts = 0;
+    for (uint32_t bits = occupancy.ColumnX(OccupancyClass::Translucent, y, z);
+         bits != 0; bits &= bits - 1)
+    {
+        const uint8_t x = static_cast<uint8_t>(std::countr_zero(bits));
+        const BlockType block = chunk.GetBlock(x, y, z);
+        if (block == BlockType::Leaves)
+            row.Leaves |= 1u << x;
+        else if (!IsTransparent(block))
+            row.OtherCutouts |= 1u << x;
+    }
+    if ((row.Opaque | row.Leaves | row.OtherCutouts) == 0)
+        return false;
+
+    const std::array<uint32_t, MeshBuilder::NUM_FACES> neighborOpaque =
+        NeighborRows(chunk, OccupancyClass::Opaque, y, z);
+    for (size_t face = 0; face < MeshBuilder::NUM_FACES; face++)
+        row.Lit[face] = ~neighborOpaque[face];
+    return true;
+}
+
+uint64_t MeshBuilder::HashShadowInputs(const Chunk& chunk,
+                                       size_t section) const
+{
+    uint64_t hash = 0;
+    ShadowRow row{};
+    const uint8_t minY = static_cast<uint8_t>(section * SECTION_HEIGHT);
+    for (uint8_t y = minY; y < minY + SECTION_HEIGHT; y++)
+    {
+        for (uint8_t z = 0; z < CHUNK_DIMENSION; z++)
+        {
+            if (!ReadShadowRow(chunk, y, z, row))
+                continue;
+
+            hash = SplitMix64(hash ^ (static_cast<uint64_t>(y) << 8 | z));
+            for (size_t face = 0; face < NUM_FACES; face++)
+            {
+                const uint32_t lit = row.Lit[face];
+                hash = SplitMix64(hash ^ (row.Opaque & lit) ^
+                                  static_cast<uint64_t>(row.Leaves & lit)
+                                      << 32);
+                hash = SplitMix64(hash ^ (row.OtherCutouts & lit));
+            }
+            // Those keep their own texture
+            for (uint32_t bits = row.OtherCutouts; bits != 0;
+                 bits &= bits - 1)
+            {
+                const uint8_t x = static_cast<uint8_t>(std::countr_zero(bits));
+                hash = SplitMix64(hash ^ static_cast<uint64_t>(
+                                             chunk.GetBlock(x, y, z)));
+            }
+        }
+    }
+    return hash;
+}
+
+void MeshBuilder::BuildShadow(const Chunk& chunk)
+{
+    for (ArenaAllocator& arena : m_Shadow)
+        arena.Clear();
+    m_ShadowQuads.clear();
+    m_ShadowCorners.fill(0);
+    for (auto& layer : m_ShadowSlices)
+    {
+        for (auto& slices : layer)
+        {
+            for (auto& slice : slices)
+                slice.fill(0);
+        }
+    }
+
+    // Adds the blocks of a row along X to the faces to merge
+    const auto mark = [this](size_t layer, size_t face, uint8_t y, uint8_t z,
+                             uint32_t bits)
+    {
+        switch (static_cast<BlockFace>(face))
+        {
+        case BlockFace::PosY:
+        case BlockFace::NegY:
+            m_ShadowSlices[layer][face][y][z] |= bits;
+            break;
+        case BlockFace::PosZ:
+        case BlockFace::NegZ:
+            m_ShadowSlices[layer][face][z][y] |= bits;
+            break;
+        default:
+            for (; bits != 0; bits &= bits - 1)
+                m_ShadowSlices[layer][face][std::countr_zero(bits)][y] |= 1u
+                                                                        << z;
+            break;
+        }
+    };
+
+    ShadowRow row{};
+    for (uint8_t y = 0; y < CHUNK_DIMENSION; y++)
+    {
+        for (uint8_t z = 0; z < CHUNK_DIMENSION; z++)
+        {
+            if (!ReadShadowRow(chunk, y, z, row))
+                continue;
+
+            for (size_t face = 0; face < NUM_FACES; face++)
+            {
+                mark(k_OpaqueShadowLayer, face, y, z,
+                     row.Opaque & row.Lit[face]);
+                mark(k_LeavesShadowLayer, face, y, z,
+                     row.Leaves & row.Lit[face]);
+                for (uint32_t bits = row.OtherCutouts & row.Lit[face];
+                     bits != 0; bits &= bits - 1)
+                {
+                    const uint8_t x =
+                        static_cast<uint8_t>(std::countr_zero(bits));
+                    AddShadowQuad(static_cast<BlockFace>(face),
+                                  chunk.GetBlock(x, y, z), {x, y, z},
+                                  {1, 1, 1});
+                }
+            }
+        }
+    }
+
+    for (size_t face = 0; face < NUM_FACES; face++)
+    {
+        MergeShadowFaces(static_cast<BlockFace>(face), k_OpaqueShadowLayer,
+                         k_MergedShadowBlock);
+        MergeShadowFaces(static_cast<BlockFace>(face), k_LeavesShadowLayer,
+                         BlockType::Leaves);
+    }
+    for (const ShadowQuad& quad : m_ShadowQuads)
+        EmitShadowQuad(quad);
+    for (size_t face = 0; face < NUM_FACES; face++)
+    {
+        m_ShadowCounts[face] =
+            static_cast<uint32_t>(ScratchVertices(m_Shadow[face]).size());
+    }
+}
+
+std::span<const ChunkVertex> MeshBuilder::GetShadow(BlockFace face) const
+{
+    return ScratchVertices(m_Shadow[static_cast<size_t>(face)]);
+}
+
+void MeshBuilder::GatherShadow(std::vector<ChunkVertex>& vertices) const
+{
+    GatherScratch(m_Shadow, vertices);
+}
+
+void MeshBuilder::MergeShadowFaces(BlockFace face, size_t layer,
+                                   BlockType blockType)
+{
+    const size_t faceIndex = static_cast<size_t>(face);
+    for (uint8_t slice = 0; slice < CHUNK_DIMENSION; slice++)
+    {
+        std::array<uint32_t, CHUNK_DIMENSION_U>& rows =
+            m_ShadowSlices[layer][faceIndex][slice];
+        for (uint8_t row = 0; row < CHUNK_DIMENSION; row++)
+        {
+            while (rows[row] != 0)
+            {
+                // The first run of the row, grown over the rows after it for
+                // as long as they have all of it
+                const int first = std::countr_zero(rows[row]);
+                const int width = std::countr_one(rows[row] >> first);
+                const uint32_t run =
+                    (width == CHUNK_DIMENSION ? ~0u : (1u << width) - 1)
+                    << first;
+                uint8_t height = 1;
+                while (row + height < CHUNK_DIMENSION &&
+                       (rows[row + height] & run) == run)
+                {
+                    rows[row + height] &= ~run;
+                    height++;
+                }
+                rows[row] &= ~run;
+
+                const uint8_t column = static_cast<uint8_t>(first);
+                const uint8_t length = static_cast<uint8_t>(width);
+                switch (face)
+                {
+                case BlockFace::PosY:
+                case BlockFace::NegY:
+                    AddShadowQuad(face, blockType,
+                                  {column, slice, row}, {length, 1, height});
+                    break;
+                case BlockFace::PosZ:
+                case BlockFace::NegZ:
+                    AddShadowQuad(face, blockType,
+                                  {column, row, slice}, {length, height, 1});
+                    break;
+                default:
+                    AddShadowQuad(face, blockType,
+                                  {slice, row, column}, {1, height, length});
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void MeshBuilder::BuildSectionPerBlock(const Chunk& chunk, size_t section)
+{
+    // Y is the most significant coordinate of the block index, so a section
+    // is a contiguous run of blocks
+    constexpr size_t sectionVolume = CHUNK_AREA_U * SECTION_HEIGHT;
+    const size_t begin = section * sectionVolume;
+    for (size_t i = begin; i < begin + sectionVolume; i++)
+    {
+        HandleBlock(chunk, i);
+    }
+}
+
+void MeshBuilder::BuildSectionBitwise(const Chunk& chunk, size_t section)
+{
+    const ChunkOccupancy& occupancy = chunk.GetOccupancy();
+    const int minY = static_cast<int>(section) * SECTION_HEIGHT;
+
+    // Same rules as HandleBlock(): opaque blocks show the faces next to
+    // anything translucent, water only the faces next to air, and leaves
+    // every face
+    for (int y = minY; y < minY + SECTION_HEIGHT; y++)
+    {
+        const uint8_t localY = static_cast<uint8_t>(y);
+        for (uint8_t z = 0; z < CHUNK_DIMENSION; z++)
+        {
+            if (occupancy.ColumnX(OccupancyClass::NonAir, localY, z) == 0)
+                continue;
+
+            const uint32_t opaque =
+                occupancy.ColumnX(OccupancyClass::Opaque, localY, z);
+            const uint32_t translucent =
+                occupancy.ColumnX(OccupancyClass::Translucent, localY, z);
+            uint32_t water = 0;
+            for (uint32_t bits = translucent; bits != 0; bits &= bits - 1)
+            {
+                const uint8_t x = static_cast<uint8_t>(std::countr_zero(bits));
+                if (IsTransparent(chunk.GetBlock(x, localY, z)))
+                    water |= 1u << x;
+            }
+            const uint32_t leaves = translucent & ~water;
+
+            const std::array<uint32_t, NUM_FACES> neighborOpaque =
+                NeighborRows(chunk, OccupancyClass::Opaque, y, z);
+            const std::array<uint32_t, NUM_FACES> neighborNonAir =
+                NeighborRows(chunk, OccupancyClass::NonAir, y, z);
+
+            std::array<uint32_t, NUM_FACES> visible{};
+            uint32_t anyVisible = 0;
+            for (size_t face = 0; face < NUM_FACES; face++)
+            {
+                visible[face] = (opaque & ~neighborOpaque[face]) | leaves |
+                                (water & ~neighborNonAir[face]);
+                anyVisible |= visible[face];
+            }
+
+            for (uint32_t bits = anyVisible; bits != 0; bits &= bits - 1)
+            {
+                const uint8_t x = static_cast<uint8_t>(std::countr_zero(bits));
+                const BlockType block = chunk.GetBlock(x, localY, z);
+                const LocalBlockCoords coords{x, localY, z};
+                const uint32_t neighborhood = GetNeighborhood(coords);
+                for (size_t face = 0; face < NUM_FACES; face++)
+                {
+                    if (visible[face] & (1u << x))
+                        AddFace(static_cast<BlockFace>(face), block, coords,
+                                neighborhood);
+                }
+            }
+        }
+    }
+}
+
+void MeshBuilder::HandleBlock(const Chunk& chunk, size_t i)
+{
+    const BlockType block = chunk.GetBlock(i);
+    if (block == BlockType::Air)
+    {
+        return;
+    }
+    const LocalBlockCoords localCoords = ChunkUtils::ExtractLocalBlockCoords(i);
+    const uint32_t neighborhood = GetNeighborhood(localCoords);
+
+    for (size_t face = 0; face < static_cast<size_t>(BlockFace::Count); face++)
+    {
+        const BlockCoords neighborCoords =
+            ChunkUtils::k_FaceNormals[face] + localCoords;
+
+        const BlockType neighborBlock = GetBlock(chunk, neighborCoords);
+
+        if ((!IsTranslucent(block) && !IsTranslucent(neighborBlock)) ||
+            (IsTransparent(block) && neighborBlock != BlockType::Air))
+            continue;
+
+        // if (!IsTransparent(neighborBlock) || neighborBlock == block)
+        // continue;
+
+        AddFace(static_cast<BlockFace>(face), block, localCoords,
+                neighborhood);
+    }
+}
+
+void MeshBuilder::PadOpaqueRows(const Chunk& chunk, int minY, int maxY)
+{
+    for (int y = minY; y <= maxY; y++)
+    {
+        const int chunkY = ChunkOffset(y);
+        const int localY = y - chunkY * CHUNK_DIMENSION;
+        for (int z = -1; z <= CHUNK_DIMENSION; z++)
+        {
+            const int chunkZ = ChunkOffset(z);
+            const int localZ = z - chunkZ * CHUNK_DIMENSION;
+
+            // Bit 31 of the row to the left and bit 0 of the one to the
+            // right are the blocks right across the chunk border
+            const uint32_t leftRow =
+                ColumnXOrAir(chunk.GetNeighbor(-1, chunkY, chunkZ),
+                             OccupancyClass::Opaque, localY, localZ);
+            const uint32_t row =
+                ColumnXOrAir(chunk.GetNeighbor(0, chunkY, chunkZ),
+                             OccupancyClass::Opaque, localY, localZ);
+            const uint32_t rightRow =
+                ColumnXOrAir(chunk.GetNeighbor(1, chunkY, chunkZ),
+                             OccupancyClass::Opaque, localY, localZ);
+
+            m_PaddedOpaque[static_cast<size_t>(y + 1) * PADDED_DIMENSION +
+                           static_cast<size_t>(z + 1)] =
+                (leftRow >> 31) | (static_cast<uint64_t>(row) << 1) |
+                (static_cast<uint64_t>(rightRow & 1u) << (CHUNK_DIMENSION + 1));
+        }
+    }
+}
+
+uint32_t MeshBuilder::GetNeighborhood(LocalBlockCoords coords) const
+{
+    uint32_t neighborhood = 0;
+    for (size_t dy = 0; dy < 3; dy++)
+    {
+        for (size_t dz = 0; dz < 3; dz++)
+        {
+            // Rows are padded by one, so this is the row at y + dy - 1
+            const uint64_t row =
+                m_PaddedOpaque[(coords.Y + dy) * PADDED_DIMENSION + coords.Z +
+                               dz];
+            neighborhood |= static_cast<uint32_t>((row >> coords.X) & 0x7u)
+                            << (3 * dz + 9 * dy);
+        }
+    }
+    return neighborhood;
+}
+
+void MeshBuilder::AddFace(BlockFace face, BlockType blockType,
+                          LocalBlockCoords offset, uint32_t neighborhood)
+{
+    const size_t faceIndex = static_cast<size_t>(face);
+    ArenaAllocator& arena = blockType == BlockType::Water
+                                ? m_Transparent[faceIndex]
+                                : m_Opaque[faceIndex];
+    ChunkVertex* const vertices = static_cast<ChunkVertex*>(
+        arena.AllocBytes(sizeof(ChunkVertex) * ChunkVertex::VERTICES_PER_FACE,
+                         alignof(ChunkVertex)));
+
+    const uint16_t occlusion =
+        k_FaceOcclusion[faceIndex][PlaneIndex(faceIndex, neighborhood)];
+    for (size_t i = 0; i < ChunkVertex::VERTICES_PER_FACE; i++)
+    {
+        ChunkVertex vertex = k_FaceVertices[faceIndex][i];
+        vertex.SetAmbientOcclusion(
+            static_cast<uint8_t>((occlusion >> (2 * i)) & 0x3u));
+        vertex.Offset(offset.X, offset.Y, offset.Z);
+        vertex.SetTextureIndex(GetTextureIndex(face, blockType));
+        vertices[i] = vertex;
+    }
+}
+
+void MeshBuilder::AddShadowQuad(BlockFace face, BlockType blockType,
+                                LocalBlockCoords offset, LocalBlockCoords size)
+{
+    m_ShadowQuads.push_back({face, blockType, offset, size});
+
+    const auto mark = [this](const GridPoint& point)
+    {
+        const size_t index = ShadowCornerIndex(point);
+        m_ShadowCorners[index / 64] |= uint64_t{1} << (index % 64);
+    };
+    const std::array<GridPoint, 4> corners = QuadCorners(face, offset, size);
+    const int normalAxis = NormalAxis(face);
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        const GridPoint& from = corners[i];
+        const GridPoint& to = corners[(i + 1) % corners.size()];
+        mark(from);
+
+        // The neighbors' rectangles can have corners anywhere along the
+        // chunk's border, so sides along it get split at every block
+        const int axis = SideAxis(from, to);
+        const int across = 3 - axis - normalAxis;
+        if (from[across] != 0 && from[across] != CHUNK_DIMENSION)
+            continue;
+        const int step = to[axis] > from[axis] ? 1 : -1;
+        GridPoint point = from;
+        for (point[axis] += step; point[axis] != to[axis];
+             point[axis] += step)
+            mark(point);
+    }
+}
+
+void MeshBuilder::EmitShadowQuad(const ShadowQuad& quad)
+{
+    const size_t faceIndex = static_cast<size_t>(quad.Face);
+    const std::array<GridPoint, 4> corners =
+        QuadCorners(quad.Face, quad.Offset, quad.Size);
+    const int normalAxis = NormalAxis(quad.Face);
+
+    // Where each corner is among the points around the rectangle
+    std::array<GridPoint, 4 * CHUNK_DIMENSION_U> boundary;
+    std::array<size_t, 4> cornerPoints{};
+    size_t count = 0;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        const GridPoint& from = corners[i];
+        const GridPoint& to = corners[(i + 1) % corners.size()];
+        const int axis = SideAxis(from, to);
+        const int step = to[axis] > from[axis] ? 1 : -1;
+
+        cornerPoints[i] = count;
+        boundary[count++] = from;
+        GridPoint point = from;
+        for (point[axis] += step; point[axis] != to[axis];
+             point[axis] += step)
+        {
+            const size_t index = ShadowCornerIndex(point);
+            if ((m_ShadowCorners[index / 64] >> (index % 64)) & 1)
+                boundary[count++] = point;
+        }
+    }
+
+    // Every triangle has to have an edge between each two points next to
+    // each other around the rectangle, and no others along its sides
+    const int uAxis = normalAxis == 0 ? 1 : 0;
+    const int vAxis = normalAxis == 2 ? 1 : 2;
+    const std::array<int, 3> size{quad.Size.X, quad.Size.Y, quad.Size.Z};
+    const bool thin = size[uAxis] == 1 || size[vAxis] == 1;
+    size_t numVertices = 0;
+    if (count == corners.size())
+        numVertices = ChunkVertex::VERTICES_PER_FACE;
+    else if (thin)
+        numVertices = 3 * (count - 2);
+    else
+        numVertices = 3 * count;
+
+    ChunkVertex* vertices =
+        static_cast<ChunkVertex*>(m_Shadow[faceIndex].AllocBytes(
+            sizeof(ChunkVertex) * numVertices, alignof(ChunkVertex)));
+    const auto addTriangle =
+        [&quad, &vertices](const GridPoint& a, const GridPoint& b,
+                           const GridPoint& c)
+    {
+        for (const GridPoint& point : {a, b, c})
+        {
+            ChunkVertex vertex{static_cast<uint8_t>(point[0]),
+                               static_cast<uint8_t>(point[1]),
+                               static_cast<uint8_t>(point[2]), 0, 0,
+                               quad.Face};
+            vertex.SetTextureIndex(GetTextureIndex(quad.Face, quad.Block));
+            *vertices++ = vertex;
+        }
+    };
+
+    if (count == corners.size())
+    {
+        addTriangle(corners[0], corners[1], corners[2]);
+        addTriangle(corners[0], corners[2], corners[3]);
+    }
+    else if (thin)
+    {
+        // A strip between the two long sides, in step along them. The short
+        // sides are a block long, so have no points between their corners
+        const size_t side = size[SideAxis(corners[0], corners[1])] > 1 ? 0 : 1;
+        const int axis = SideAxis(corners[side], corners[side + 1]);
+        // Both from the same short side, the second backward around the
+        // rectangle
+        const auto first = [&](size_t i)
+        { return boundary[cornerPoints[side] + i]; };
+        const auto second = [&](size_t i)
+        {
+            const size_t end = side == 0 ? cornerPoints[3] : count;
+            return boundary[(end - i) % count];
+        };
+        const size_t firstCount = cornerPoints[side + 1] - cornerPoints[side];
+        const size_t secondCount =
+            (side == 0 ? cornerPoints[3] : count) - cornerPoints[side + 2];
+        const int start = first(0)[axis];
+        size_t i = 0;
+        size_t j = 0;
+        while (i < firstCount || j < secondCount)
+        {
+            const bool advanceFirst =
+                j == secondCount ||
+                (i < firstCount && std::abs(first(i + 1)[axis] - start) <=
+                                       std::abs(second(j + 1)[axis] - start));
+            if (advanceFirst)
+            {
+                addTriangle(first(i), first(i + 1), second(j));
+                i++;
+            }
+            else
+            {
+                addTriangle(first(i), second(j + 1), second(j));
+                j++;
+            }
+        }
+    }
+    else
+    {
+        // Around a point inside, on none of the sides
+        const std::array<int, 3> offset{quad.Offset.X, quad.Offset.Y,
+                                        quad.Offset.Z};
+        GridPoint center = corners[0];
+        center[uAxis] = offset[uAxis] + size[uAxis] / 2;
+        center[vAxis] = offset[vAxis] + size[vAxis] / 2;
+        for (size_t i = 0; i < count; i++)
+            addTriangle(boundary[i], boundary[(i + 1) % count], center);
+    }
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Block.h"
+#include "ChunkVertex.h"
+#include "Core/Common.h"
+#include "Memory/ArenaAllocator.h"
+#include "World/Coordinates.h"
+#include <array>
+#include <span>
+#include <vector>
+
+class Chunk;
+
+enum class MeshingKernel : uint8_t
+{
+    // Looks up the six neighbors of every block
+    PerBlock,
+    // Culls the faces of a whole row of blocks at once with the chunk's
+    // occupancy columns, then only visits blocks that have a visible face
+    Bitwise
+};
+
+// Builds the vertices of a chunk on the CPU, without touching GL, from the
+// chunk's blocks and those of its neighbors. Vertices go into scratch space
+// owned by the builder, one per thread, and stay valid until the next build.
+// There is one arena per face direction, so the faces come out grouped by
+// direction. The worst case is only reserved, pages are committed as meshes
+// grow into them and kept for the builds after
+class MeshBuilder
+{
+  public:
+    // Bump whenever the same blocks would mesh to different vertices, so that
+    // MeshCache entries built by older versions are no longer found
+    static constexpr uint32_t VERSION = 1;
+
+    // Meshes are split into horizontal slabs, so that edits only remesh and
+    // upload the slabs around them
+    static constexpr size_t NUM_SECTIONS = 8;
+    static constexpr int SECTION_HEIGHT = CHUNK_DIMENSION / NUM_SECTIONS;
+    static constexpr uint8_t ALL_SECTIONS = 0xFF;
+
+    // The faces of each direction are kept together, one range per section,
+    // so that the directions facing away from the viewer can be skipped when
+    // drawing
+    static constexpr size_t NUM_FACES = static_cast<size_t>(BlockFace::Count);
+    static constexpr size_t NUM_RANGES = NUM_FACES * NUM_SECTIONS;
+    static constexpr uint8_t ALL_FACES = (1u << NUM_FACES) - 1;
+
+    static constexpr size_t RangeIndex(BlockFace face, size_t section)
+    {
+        return static_cast<size_t>(face) * NUM_SECTIONS + section;
+    }
+
+    // The ranges of the given sections, in every face direction
+    static constexpr uint64_t RangesForSections(uint8_t sections)
+    {
+        uint64_t ranges = 0;
+        for (size_t face = 0; face < NUM_FACES; face++)
+            ranges |= static_cast<uint64_t>(sections) << (face * NUM_SECTIONS);
+        return ranges;
+    }
+
+    // The sections whose vertices depend on the blocks in rows minY to maxY.
+    // Faces and ambient occlusion look one block further, so the rows right
+    // above and below count too
+    static constexpr uint8_t SectionsForRows(int minY, int maxY)
+    {
+        const int lo = (minY > 0 ? minY - 1 : 0) / SECTION_HEIGHT;
+        const int hi = (maxY < CHUNK_DIMENSION - 1 ? maxY + 1 : maxY) /
+                       SECTION_HEIGHT;
+        return static_cast<uint8_t>(((1u << (hi + 1)) - 1) &
+                                    ~((1u << lo) - 1));
+    }
+
+    MeshBuilder();
+
+    MeshBuilder(const MeshBuilder&) = delete;
+    MeshBuilder& operator=(const MeshBuilder&) = delete;
+
+    // Builds the vertices of the given sections, the others are left empty.
+    // Both kernels produce the same vertices in the same order
+    void Build(const Chunk& chunk, uint8_t sections = ALL_SECTIONS,
+               MeshingKernel kernel = MeshingKernel::Bitwise);
+
+    // The vertices of one direction, its sections one after the other
+    std::span<const ChunkVertex> GetOpaque(BlockFace face) const;
+    std::span<const ChunkVertex> GetTransparent(BlockFace face) const;
+
+    // Vertex counts of every range, indexed by RangeIndex()
+    const std::array<uint32_t, NUM_RANGES>& GetOpaqueCounts() const
+    {
+        return m_OpaqueCounts;
+    }
+    const std::array<uint32_t, NUM_RANGES>& GetTransparentCounts() const
+    {
+        return m_TransparentCounts;
+    }
+
+    size_t NumVertices() const;
+
+    // Copies every range in order into one exactly sized vector
+    void GatherOpaque(std::vector<ChunkVertex>& vertices) const;
+    void GatherTransparent(std::vector<ChunkVertex>& vertices) const;
+
+    // Builds the mesh the shadow cascades are drawn with, always of the whole
+    // chunk. Depth needs no ambient occlusion, and only leaves need their
+    // texture, for the alpha test, so the faces of opaque blocks get greedily
+    // merged into rectangles whatever their blocks, and those of leaves with
+    // each other. Faces against opaque blocks are left out, light never
+    // reaches them. There is one range per direction, so sections don't
+    // split rectangles. The rectangles are split where others' corners meet
+    // their sides, so that the shadow map has no cracks along them
+    void BuildShadow(const Chunk& chunk);
+    // Of everything BuildShadow() reads for the rows of one section, the
+    // blocks that cast shadows and which of their faces can be lit. A section
+    // whose hash didn't change adds the same faces to the shadow mesh
+    uint64_t HashShadowInputs(const Chunk& chunk, size_t section) const;
+
+    std::span<const ChunkVertex> GetShadow(BlockFace face) const;
+    const std::array<uint32_t, NUM_FACES>& GetShadowCounts() const
+    {
+        return m_ShadowCounts;
+    }
+    void GatherShadow(std::vector<ChunkVertex>& vertices) const;
+
+  private:
+    struct ShadowQuad
+    {
+        BlockFace Face;
+        BlockType Block;
+        LocalBlockCoords Offset;
+        LocalBlockCoords Size;
+    };
+
+    void BuildSectionPerBlock(const Chunk& chunk, size_t section);
+    void BuildSectionBitwise(const Chunk& chunk, size_t section);
+
+    void HandleBlock(const Chunk& chunk, size_t i);
+
+    // Fills the padded rows for y in [minY, maxY], which may reach one past
+    // the chunk
+    void PadOpaqueRows(const Chunk& chunk, int minY, int maxY);
+    // Which of the 27 blocks around and including the block are opaque, read
+    // from the padded rows
+    uint32_t GetNeighborhood(LocalBlockCoords coords) const;
+
+    void AddFace(BlockFace face, BlockType blockType, LocalBlockCoords offset,
+                 uint32_t neighborhood);
+
+    // Merges the faces of one direction and layer, one slice along its
+    // normal at a time, into as few rectangles as it can
+    void MergeShadowFaces(BlockFace face, size_t layer, BlockType blockType);
+    // Corner at offset, size blocks along each axis of the face. Only
+    // recorded, the vertices come once every rectangle's corners are known
+    void AddShadowQuad(BlockFace face, BlockType blockType,
+                       LocalBlockCoords offset, LocalBlockCoords size);
+    // Triangulates the rectangle through every marked point on its sides,
+    // so that no edge ends partway along another and the mesh has no cracks
+    void EmitShadowQuad(const ShadowQuad& quad);
+
+  private:
+    static constexpr size_t PADDED_DIMENSION = CHUNK_DIMENSION_U + 2;
+
+    std::array<ArenaAllocator, NUM_FACES> m_Opaque{};
+    std::array<ArenaAllocator, NUM_FACES> m_Transparent{};
+    std::array<uint32_t, NUM_RANGES> m_OpaqueCounts{};
+    std::array<uint32_t, NUM_RANGES> m_TransparentCounts{};
+    std::array<ArenaAllocator, NUM_FACES> m_Shadow{};
+    std::array<uint32_t, NUM_FACES> m_ShadowCounts{};
+    std::vector<ShadowQuad> m_ShadowQuads{};
+
+    // Faces only merge with those of the same layer
+    static constexpr size_t k_OpaqueShadowLayer = 0;
+    static constexpr size_t k_LeavesShadowLayer = 1;
+    static constexpr size_t NUM_SHADOW_LAYERS = 2;
+
+    // The faces left to merge, for each layer, direction and slice along the
+    // direction's normal. A slice is a row for each block along one axis of
+    // the face, with a bit for each block along the other
+    std::array<std::array<std::array<std::array<uint32_t, CHUNK_DIMENSION_U>,
+                                     CHUNK_DIMENSION_U>,
+                          NUM_FACES>,
+               NUM_SHADOW_LAYERS>
+        m_ShadowSlices{};
+
+    // A bit for each point of the block grid that's a corner of any of the
+    // rectangles, or on one of their sides along the chunk's border
+    static constexpr size_t SHADOW_CORNER_DIMENSION = CHUNK_DIMENSION_U + 1;
+    static constexpr size_t NUM_SHADOW_CORNERS = SHADOW_CORNER_DIMENSION *
+                                                 SHADOW_CORNER_DIMENSION *
+                                                 SHADOW_CORNER_DIMENSION;
+    std::array<uint64_t, (NUM_SHADOW_CORNERS + 63) / 64> m_ShadowCorners{};
+
+    // Opaque occupancy of the chunk with a one block border taken from its
+    // neighbors, one row along X for each (y, z) in [-1, CHUNK_DIMENSION].
+    // Bit x + 1 is the block at x, so the neighborhood of any block in the
+    // chunk can be read without checking for chunk borders
+    std::array<uint64_t, PADDED_DIMENSION * PADDED_DIMENSION>
+        m_PaddedOpaque{};
+};
@@ -0,0 +1,242 @@
+#include "MeshCache.h"
+#include "ChunkMesh.h"
+#include "Core/Logger.h"
+#include "Platform/PlatformFile.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <numeric>
+#include <span>
+#include <vector>
+
+static constexpr uint32_t k_Magic = 0x4853454D; // "MESH"
+
+// Followed by the opaque and then the transparent vertices, range by range
+struct EntryHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t Key;
+    std::array<uint32_t, MeshBuilder::NUM_RANGES> OpaqueCounts;
+    std::array<uint32_t, MeshBuilder::NUM_RANGES> TransparentCounts;
+};
+
+static_assert(sizeof(EntryHeader) % alignof(ChunkVertex) == 0,
+              "Vertices follow the header directly");
+
+static size_t Total(const std::array<uint32_t, MeshBuilder::NUM_RANGES>& counts)
+{
+    return std::accumulate(counts.begin(), counts.end(), size_t{0});
+}
+
+MeshCache::MeshCache(std::filesystem::path directory, size_t maxBytes)
+    : m_Directory{std::move(directory)}, m_MaxBytes{maxBytes}
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_Directory, error);
+    m_Writable = !error;
+    if (!m_Writable)
+    {
+        const std::string path = m_Directory.string();
+        LOG_WARN("Mesh cache directory {} unavailable, not storing meshes",
+                 path);
+        return;
+    }
+
+    ScanDirectory();
+    Evict();
+    LOG_INFO("Mesh cache: {} entries, {} KiB", m_Entries.size(),
+             m_NumBytes >> 10);
+}
+
+bool MeshCache::Load(uint64_t key, ChunkMesh& mesh)
+{
+    // Saves opening a file for every miss
+    const auto it = m_EntriesByKey.find(key);
+    if (it == m_EntriesByKey.end())
+        return false;
+
+    const std::filesystem::path entryPath = EntryPath(key);
+    const std::string path = entryPath.string();
+    size_t numBytes = 0;
+    const void* const data = Platform::MapFileRead(path.c_str(), numBytes);
+    if (!data)
+    {
+        RemoveEntry(key);
+        return false;
+    }
+
+    // Cheap checks only, the key already pins down the contents. Anything
+    // that doesn't add up, e.g. a write cut short, is treated as a miss
+    EntryHeader header;
+    bool valid = numBytes >= sizeof(EntryHeader);
+    if (valid)
+    {
+        std::memcpy(&header, data, sizeof(EntryHeader));
+        valid = header.Magic == k_Magic &&
+                header.Version == MeshBuilder::VERSION && header.Key == key;
+    }
+    const size_t numOpaque = valid ? Total(header.OpaqueCounts) : 0;
+    const size_t numTransparent = valid ? Total(header.TransparentCounts) : 0;
+    valid = valid && numBytes == sizeof(EntryHeader) +
+                                     (numOpaque + numTransparent) *
+                                         sizeof(ChunkVertex);
+
+    if (valid)
+    {
+        // Mappings are page aligned, and so are the vertices after the header
+        const ChunkVertex* const vertices =
+            reinterpret_cast<const ChunkVertex*>(
+                static_cast<const uint8_t*>(data) + sizeof(EntryHeader));
+        mesh.SetPending({vertices, numOpaque}, header.OpaqueCounts,
+                        {vertices + numOpaque, numTransparent},
+                        header.TransparentCounts);
+    }
+
+    Platform::UnmapFile(data, numBytes);
+
+    std::error_code error;
+    if (valid)
+    {
+        m_Entries.splice(m_Entries.end(), m_Entries, it->second);
+        std::filesystem::last_write_time(
+            entryPath, std::filesystem::file_time_type::clock::now(), error);
+    }
+    else
+    {
+        // Gets written again on the next miss
+        std::filesystem::remove(entryPath, error);
+        RemoveEntry(key);
+    }
+    return valid;
+}
+
+void MeshCache::Store(uint64_t key, const ChunkMesh& mesh)
+{
+    if (!m_Writable)
+        return;
+
+    const EntryHeader header{k_Magic, MeshBuilder::VERSION, key,
+                             mesh.GetPendingOpaqueCounts(),
+                             mesh.GetPendingTransparentCounts()};
+    const std::span<const ChunkVertex> opaque = mesh.GetPendingOpaque();
+    const std::span<const ChunkVertex> transparent =
+        mesh.GetPendingTransparent();
+
+    // Written next to the entry and renamed over it, so a reader never sees
+    // half a file under the entry's name
+    const std::filesystem::path path = EntryPath(key);
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    bool written = false;
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(opaque.data()),
+                   static_cast<std::streamsize>(opaque.size_bytes()));
+        file.write(reinterpret_cast<const char*>(transparent.data()),
+                   static_cast<std::streamsize>(transparent.size_bytes()));
+        written = static_cast<bool>(file);
+    }
+
+    std::error_code error;
+    if (written)
+        std::filesystem::rename(tempPath, path, error);
+    if (!written || error)
+    {
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+
+    AddEntry(key, sizeof(header) + opaque.size_bytes() +
+                      transparent.size_bytes());
+    Evict();
+}
+
+std::filesystem::path MeshCache::EntryPath(uint64_t key) const
+{
+    return m_Directory / std::format("{:016x}.mesh", key);
+}
+
+void MeshCache::ScanDirectory()
+{
+    struct FoundEntry
+    {
+        std::filesystem::file_time_type WriteTime;
+        uint64_t Key;
+        size_t NumBytes;
+    };
+    std::vector<FoundEntry> found{};
+    std::vector<std::filesystem::path> leftovers{};
+
+    std::error_code error;
+    for (std::filesystem::directory_iterator it{m_Directory, error};
+         !error && it != std::filesystem::directory_iterator{};
+         it.increment(error))
+    {
+        const std::filesystem::path& path = it->path();
+        // Temporary files of writes that were cut short
+        if (path.extension() == ".tmp")
+        {
+            leftovers.push_back(path);
+            continue;
+        }
+        if (path.extension() != ".mesh")
+            continue;
+
+        const std::string stem = path.stem().string();
+        uint64_t key = 0;
+        const auto [end, parseError] =
+            std::from_chars(stem.data(), stem.data() + stem.size(), key, 16);
+        if (parseError != std::errc{} || end != stem.data() + stem.size())
+            continue;
+
+        std::error_code fileError;
+        const uintmax_t numBytes = it->file_size(fileError);
+        const std::filesystem::file_time_type writeTime =
+            it->last_write_time(fileError);
+        if (!fileError)
+            found.push_back({writeTime, key, static_cast<size_t>(numBytes)});
+    }
+
+    for (const std::filesystem::path& path : leftovers)
+        std::filesystem::remove(path, error);
+
+    std::sort(found.begin(), found.end(),
+              [](const FoundEntry& a, const FoundEntry& b)
+              { return a.WriteTime < b.WriteTime; });
+    for (const FoundEntry& entry : found)
+        AddEntry(entry.Key, entry.NumBytes);
+}
+
+void MeshCache::AddEntry(uint64_t key, size_t numBytes)
+{
+    RemoveEntry(key);
+    m_Entries.push_back({key, numBytes});
+    m_EntriesByKey[key] = std::prev(m_Entries.end());
+    m_NumBytes += numBytes;
+}
+
+void MeshCache::RemoveEntry(uint64_t key)
+{
+    const auto it = m_EntriesByKey.find(key);
+    if (it == m_EntriesByKey.end())
+        return;
+    m_NumBytes -= it->second->NumBytes;
+    m_Entries.erase(it->second);
+    m_EntriesByKey.erase(it);
+}
+
+void MeshCache::Evict()
+{
+    while (m_NumBytes > m_MaxBytes && !m_Entries.empty())
+    {
+        const uint64_t key = m_Entries.front().Key;
+        std::error_code error;
+        std::filesystem::remove(EntryPath(key), error);
+        RemoveEntry(key);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <unordered_map>
+
+class ChunkMesh;
+
+// Finished CPU meshes on disk, so that chunks that get loaded again, also
+// after a restart, don't need to be remeshed. Entries are keyed by
+// Chunk::GetMeshKey(), which covers everything the mesh is built from, so
+// they never go stale and are never invalidated. One file per entry, read
+// through a memory mapping straight into the mesh's pending vertices. Once
+// the entries take up more than the size limit, the least recently used ones
+// get deleted. Their use is carried over restarts by the files' write times
+class MeshCache
+{
+  public:
+    // Creates the directory if needed. If that fails, nothing gets stored
+    MeshCache(std::filesystem::path directory, size_t maxBytes);
+
+    // Replaces the mesh's pending vertices with those of the entry, returns
+    // false if there is no valid entry for the key
+    bool Load(uint64_t key, ChunkMesh& mesh);
+
+    // Stores the mesh's pending vertices, which must be a complete build
+    void Store(uint64_t key, const ChunkMesh& mesh);
+
+    size_t GetNumBytes() const { return m_NumBytes; }
+
+  private:
+    struct Entry
+    {
+        uint64_t Key;
+        size_t NumBytes;
+    };
+
+    std::filesystem::path EntryPath(uint64_t key) const;
+
+    // Indexes the entries left by earlier runs, oldest first
+    void ScanDirectory();
+    void AddEntry(uint64_t key, size_t numBytes);
+    void RemoveEntry(uint64_t key);
+    void Evict();
+
+  private:
+    std::filesystem::path m_Directory;
+    size_t m_MaxBytes = 0;
+    bool m_Writable = false;
+
+    // Least recently used first
+    std::list<Entry> m_Entries{};
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_EntriesByKey{};
+    size_t m_NumBytes = 0;
+};
@@ -0,0 +1,113 @@
+#include "StreamingScheduler.h"
+#include "Core/Config.h"
+#include <algorithm>
+#include <cassert>
+
+static constexpr size_t k_NumStages =
+    static_cast<size_t>(StreamingStage::Count);
+
+// Initial guesses for the cost of a unit of work, refined as soon as the first
+// units are measured
+static constexpr std::array<float, k_NumStages> k_InitialUnitMicros{
+    300.0f, 500.0f, 50.0f, 10.0f, 800.0f, 100.0f};
+
+static constexpr std::array<int, k_NumStages> k_DefaultBudgets{
+    Config::GenerateBudgetMicros, Config::MeshBudgetMicros,
+    Config::UploadBudgetMicros, Config::UnloadBudgetMicros,
+    Config::LodBudgetMicros, Config::HorizonBudgetMicros};
+
+static const char* s_StageNames[] = {"Generate", "Mesh", "Upload", "Unload",
+                                     "LOD", "Horizon"};
+
+// Weight of the newest sample in the running average of unit costs
+static constexpr float k_CostSmoothing = 0.1f;
+static constexpr int k_MaxBatchSize = 1024;
+
+const char* StreamingStageToStr(StreamingStage stage)
+{
+    return s_StageNames[static_cast<size_t>(stage)];
+}
+
+StreamingScheduler::StreamingScheduler()
+{
+    for (size_t i = 0; i < k_NumStages; i++)
+    {
+        m_Stats[i].AvgUnitMicros = k_InitialUnitMicros[i];
+        SetBudget(static_cast<StreamingStage>(i), k_DefaultBudgets[i]);
+    }
+}
+
+void StreamingScheduler::SetBudget(StreamingStage stage, int budgetMicros)
+{
+    StreamingStageStats& stats = m_Stats[static_cast<size_t>(stage)];
+    stats.BudgetMicros = std::max(budgetMicros, 0);
+    stats.BatchSize = std::clamp(
+        static_cast<int>(stats.BudgetMicros / stats.AvgUnitMicros), 1,
+        k_MaxBatchSize);
+}
+
+void StreamingScheduler::BeginStage(StreamingStage stage)
+{
+    assert(m_CurrentStage == StreamingStage::Count &&
+           "Previous stage was not ended");
+    m_CurrentStage = stage;
+    m_StageStart = Clock::now();
+    m_Units = 0;
+    m_UnitRunning = false;
+}
+
+bool StreamingScheduler::NextUnit()
+{
+    assert(m_CurrentStage != StreamingStage::Count);
+    const Clock::time_point now = Clock::now();
+    if (m_UnitRunning)
+        RecordUnit(now);
+
+    const StreamingStageStats& stats =
+        m_Stats[static_cast<size_t>(m_CurrentStage)];
+    const float elapsed =
+        std::chrono::duration<float, std::micro>(now - m_StageStart).count();
+
+    // Don't start a unit that would, on average, blow through the budget
+    if (m_Units > 0 && (m_Units >= stats.BatchSize ||
+                        elapsed + stats.AvgUnitMicros > stats.BudgetMicros))
+    {
+        m_UnitRunning = false;
+        return false;
+    }
+
+    m_Units++;
+    m_UnitStart = now;
+    m_UnitRunning = true;
+    return true;
+}
+
+void StreamingScheduler::EndStage()
+{
+    assert(m_CurrentStage != StreamingStage::Count);
+    const Clock::time_point now = Clock::now();
+    if (m_UnitRunning)
+        RecordUnit(now);
+
+    StreamingStageStats& stats = m_Stats[static_cast<size_t>(m_CurrentStage)];
+    stats.UnitsLastTick = m_Units;
+    stats.MicrosLastTick =
+        std::chrono::duration<float, std::micro>(now - m_StageStart).count();
+    stats.BatchSize = std::clamp(
+        static_cast<int>(stats.BudgetMicros / stats.AvgUnitMicros), 1,
+        k_MaxBatchSize);
+
+    m_CurrentStage = StreamingStage::Count;
+    m_UnitRunning = false;
+}
+
+void StreamingScheduler::RecordUnit(Clock::time_point now)
+{
+    StreamingStageStats& stats = m_Stats[static_cast<size_t>(m_CurrentStage)];
+    const float micros =
+        std::chrono::duration<float, std::micro>(now - m_UnitStart).count();
+    stats.AvgUnitMicros += (micros - stats.AvgUnitMicros) * k_CostSmoothing;
+    // Keep the average away from zero so the batch size stays bounded
+    stats.AvgUnitMicros = std::max(stats.AvgUnitMicros, 0.1f);
+    m_UnitRunning = false;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+enum class StreamingStage : uint8_t
+{
+    Generate = 0,
+    Mesh,
+    Upload,
+    Unload,
+    Lod,
+    Horizon,
+    Count
+};
+
+const char* StreamingStageToStr(StreamingStage stage);
+
+struct StreamingStageStats
+{
+    int BudgetMicros = 0;
+    int BatchSize = 1;
+    float AvgUnitMicros = 0.0f;
+    int UnitsLastTick = 0;
+    float MicrosLastTick = 0.0f;
+};
+
+// Gives each stage of world streaming a per tick time budget instead of a fixed
+// number of chunks. Every unit of work is timed, and the batch size of a stage
+// follows the running average cost of a unit, so cheap work gets batched while
+// expensive work is spread over several ticks. Usage:
+//
+//   scheduler.BeginStage(StreamingStage::Mesh);
+//   while (HasWork() && scheduler.NextUnit())
+//       DoOneUnit();
+//   scheduler.EndStage();
+class StreamingScheduler
+{
+  public:
+    StreamingScheduler();
+
+    void BeginStage(StreamingStage stage);
+
+    // Finishes timing the previous unit, and returns whether another unit of
+    // work fits in the budget of this tick. At least one unit is always allowed
+    // so that every stage makes progress
+    bool NextUnit();
+
+    void EndStage();
+
+    const StreamingStageStats& GetStats(StreamingStage stage) const
+    {
+        return m_Stats[static_cast<size_t>(stage)];
+    }
+
+    void SetBudget(StreamingStage stage, int budgetMicros);
+
+  private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    void RecordUnit(Clock::time_point now);
+
+  private:
+    std::array<StreamingStageStats, static_cast<size_t>(StreamingStage::Count)>
+        m_Stats{};
+
+    StreamingStage m_CurrentStage = StreamingStage::Count;
+    Clock::time_point m_StageStart{};
+    Clock::time_point m_UnitStart{};
+    int m_Units = 0;
+    bool m_UnitRunning = false;
+};
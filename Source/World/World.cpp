@@ -6,9 +6,11 @@
 #include "ECS/Components.h"
 #include "ECS/EntityFactory.h"
 #include "Math/MathUtils.h"
+#include "Memory/ChunkAllocator.h"
 #include "Physics/PhysicsSystem.h"
 #include "Rendering/Camera.h"
 #include <algorithm>
+#include <bit>
 
 // Through profiling, realized that rebuilding meshes was a huge bottleneck
 // Realized that 4x mesh rebuilds for every chunk load
@@ -18,17 +20,154 @@
 
 extern DebugState g_DebugState;
 
+// Weight of the newest position delta in the velocity used for prefetching
+static constexpr float k_VelocitySmoothing = 0.2f;
+
+static bool InLoadDistance(ChunkCoords chunkCoords, ChunkCoords playerCoords)
+{
+    const ChunkCoords diff = chunkCoords - playerCoords;
+    return std::abs(diff.X) <= Config::ChunkLoadDistance &&
+           std::abs(diff.Y) <= Config::ChunkLoadDistance &&
+           std::abs(diff.Z) <= Config::ChunkLoadDistance;
+}
+
+static constexpr uint8_t k_AllFaces =
+    (1u << static_cast<uint8_t>(BlockFace::Count)) - 1;
+
+// Bit mask of the faces, indexed by BlockFace, on the border of the chunk that
+// the box between min and max touches
+static uint8_t TouchedChunkBorders(LocalBlockCoords min, LocalBlockCoords max)
+{
+    constexpr uint8_t last = static_cast<uint8_t>(CHUNK_DIMENSION - 1);
+    const auto bit = [](BlockFace face) {
+        return static_cast<uint8_t>(1u << static_cast<uint8_t>(face));
+    };
+
+    uint8_t mask = 0;
+    if (max.Z == last)
+        mask |= bit(BlockFace::PosZ);
+    if (min.Z == 0)
+        mask |= bit(BlockFace::NegZ);
+    if (min.X == 0)
+        mask |= bit(BlockFace::NegX);
+    if (max.X == last)
+        mask |= bit(BlockFace::PosX);
+    if (max.Y == last)
+        mask |= bit(BlockFace::PosY);
+    if (min.Y == 0)
+        mask |= bit(BlockFace::NegY);
+    return mask;
+}
+
+// Sections is the mask of mesh sections that changed in the chunk itself. The
+// horizontal neighbors share those rows, the ones above and below only their
+// bottom and top sections
+static void TriggerNeighborRebuilds(Chunk& chunk, uint8_t faceMask,
+                                    uint8_t sections)
+{
+    for (size_t face = 0; face < static_cast<size_t>(BlockFace::Count); face++)
+    {
+        if (!(faceMask & (1u << face)))
+            continue;
+        Chunk* const neighbor = chunk.GetNeighbor(static_cast<BlockFace>(face));
+        if (!neighbor)
+            continue;
+
+        switch (static_cast<BlockFace>(face))
+        {
+        case BlockFace::PosY:
+            neighbor->TriggerRebuild(MeshBuilder::SectionsForRows(0, 0));
+            break;
+        case BlockFace::NegY:
+            neighbor->TriggerRebuild(MeshBuilder::SectionsForRows(
+                CHUNK_DIMENSION - 1, CHUNK_DIMENSION - 1));
+            break;
+        default: neighbor->TriggerRebuild(sections); break;
+        }
+    }
+}
+
+struct CloserToChunk
+{
+    ChunkCoords Origin;
+
+    bool operator()(const Chunk* c1, const Chunk* c2) const
+    {
+        const ChunkCoords diff1 = c1->GetCoords() - Origin;
+        const ChunkCoords diff2 = c2->GetCoords() - Origin;
+        return diff1.NormSq() < diff2.NormSq();
+    }
+};
+
+static ChunkCoords PredictChunk(WorldCoords position, WorldCoords velocity)
+{
+    constexpr float lookaheadTicks =
+        Config::PrefetchLookaheadSeconds * Config::TickRate;
+    constexpr float maxDistance =
+        static_cast<float>(Config::ChunkLoadDistance * CHUNK_DIMENSION);
+
+    WorldCoords offset = velocity * lookaheadTicks;
+    // Teleports look like huge velocities, don't predict past the load distance
+    const float distance = offset.Length();
+    if (distance > maxDistance)
+        offset *= maxDistance / distance;
+    return static_cast<ChunkCoords>(position + offset);
+}
+
+// Chunks left behind by a move keep their pool slots until the unload stage
+// gets to them, so they come out of the headroom too
+static size_t MaxPrefetchedChunks(size_t pendingUnloads)
+{
+    constexpr size_t bytesPerChunk =
+        sizeof(Chunk) + sizeof(BlockType) * CHUNK_VOLUME_U +
+        sizeof(ChunkOccupancy);
+    constexpr size_t budget =
+        static_cast<size_t>(Config::PrefetchBudgetMegabytes) * 1024 * 1024 /
+        bytesPerChunk;
+    // Never take pool slots away from the regular load distance or the LOD
+    // rings
+    constexpr size_t loadedChunks =
+        static_cast<size_t>(
+            MathUtils::Cube(2 * Config::ChunkLoadDistance + 1)) +
+        LodManager::MaxChunks();
+    const size_t maxChunks = g_ChunkAllocator.GetMaxChunks();
+    const size_t usedChunks = loadedChunks + pendingUnloads;
+    const size_t headroom =
+        maxChunks > usedChunks ? maxChunks - usedChunks : 0;
+    return std::min(budget, headroom);
+}
+
 void World::Init()
 {
     m_ECS.Init();
+    if (Config::EnableMeshCache)
+    {
+        m_MeshCache = std::make_unique<MeshCache>(
+            Config::MeshCacheDirectory,
+            static_cast<size_t>(Config::MeshCacheBudgetMegabytes) * 1024 *
+                1024);
+    }
     m_LightDir.Normalize();
     m_Player = EntityFactory::CreateDebugPlayer(m_ECS, {0.0f, 50.0f, 0.0f});
     m_PlayerController =
         std::make_unique<PlayerController>(m_Player, m_ECS, *this);
 
+    m_ChunkPrioritizer.Update(
+        static_cast<ChunkCoords>(
+            m_ECS.GetComponent<TransformComponent>(m_Player).Position),
+        m_PlayerVelocity, nullptr);
     UpdateLoadedChunkQueue();
     LoadChunks();
     UpdateChunkMeshes();
+    UploadChunkMeshes();
+    m_LodManager.Update(
+        static_cast<ChunkCoords>(
+            m_ECS.GetComponent<TransformComponent>(m_Player).Position),
+        m_WorldGenerator, m_StreamingScheduler);
+    if (Config::EnableHorizon)
+        m_Horizon.Update(
+            m_ECS.GetComponent<TransformComponent>(m_Player).Position,
+            m_WorldGenerator, m_StreamingScheduler);
     UpdateChunkRenderList();
     PhysicsSystem::Update(m_ECS, *this);
 }
@@ -62,30 +201,27 @@ Chunk* World::GetChunk(ChunkCoords chunkCoords)
         return nullptr;
 }
 
+const Chunk* World::GetChunk(ChunkCoords chunkCoords) const
+{
+    auto it = m_LoadedChunks.find(chunkCoords);
+    if (it != m_LoadedChunks.end())
+        return it->second;
+    else
+        return nullptr;
+}
+
 bool World::PlaceBlock(BlockType block, BlockCoords blockCoords)
 {
     const ChunkCoords chunkCoords = static_cast<ChunkCoords>(blockCoords);
     auto it = m_LoadedChunks.find(chunkCoords);
     if (it != m_LoadedChunks.end())
     {
-        const uint8_t x = static_cast<uint8_t>(blockCoords.X -
-                                               CHUNK_DIMENSION * chunkCoords.X);
-        const uint8_t y = static_cast<uint8_t>(blockCoords.Y -
-                                               CHUNK_DIMENSION * chunkCoords.Y);
-        const uint8_t z = static_cast<uint8_t>(blockCoords.Z -
-                                               CHUNK_DIMENSION * chunkCoords.Z);
-        it->second->SetBlock(block, x, y, z);
-
-        std::array<ChunkCoords, 3> buf;
-        const size_t neighborCount =
-            ChunkUtils::NeighboringChunks(chunkCoords, x, y, z, buf);
-        for (size_t i = 0; i < neighborCount; i++)
-        {
-            if (it = m_LoadedChunks.find(buf[i]); it != m_LoadedChunks.end())
-            {
-                it->second->TriggerRebuild();
-            }
-        }
+        Chunk* const chunk = it->second;
+        const LocalBlockCoords local =
+            static_cast<LocalBlockCoords>(blockCoords);
+        chunk->SetBlock(block, local.X, local.Y, local.Z);
+        TriggerNeighborRebuilds(*chunk, TouchedChunkBorders(local, local),
+                                MeshBuilder::SectionsForRows(local.Y, local.Y));
 
         return true;
     }
@@ -100,6 +236,79 @@ bool World::BreakBlock(BlockCoords blockCoords)
     return PlaceBlock(BlockType::Air, blockCoords);
 }
 
+void World::EditBatch::SetBlock(BlockType block, BlockCoords blockCoords)
+{
+    const LocalBlockCoords local = static_cast<LocalBlockCoords>(blockCoords);
+    m_Edits[static_cast<ChunkCoords>(blockCoords)].push_back(
+        {block, local, local});
+}
+
+void World::EditBatch::Fill(BlockType block, BlockCoords min, BlockCoords max)
+{
+    // Any two opposite corners make the same box
+    const BlockCoords corner = min;
+    min = {std::min(corner.X, max.X), std::min(corner.Y, max.Y),
+           std::min(corner.Z, max.Z)};
+    max = {std::max(corner.X, max.X), std::max(corner.Y, max.Y),
+           std::max(corner.Z, max.Z)};
+
+    const ChunkCoords minChunk = static_cast<ChunkCoords>(min);
+    const ChunkCoords maxChunk = static_cast<ChunkCoords>(max);
+
+    // Split the box along chunk borders, clamping it to each chunk
+    for (int cy = minChunk.Y; cy <= maxChunk.Y; cy++)
+    {
+        for (int cz = minChunk.Z; cz <= maxChunk.Z; cz++)
+        {
+            for (int cx = minChunk.X; cx <= maxChunk.X; cx++)
+            {
+                const BlockCoords origin{cx * CHUNK_DIMENSION,
+                                         cy * CHUNK_DIMENSION,
+                                         cz * CHUNK_DIMENSION};
+                const BlockCoords localMin{std::max(min.X - origin.X, 0),
+                                           std::max(min.Y - origin.Y, 0),
+                                           std::max(min.Z - origin.Z, 0)};
+                const BlockCoords localMax{
+                    std::min(max.X - origin.X, CHUNK_DIMENSION - 1),
+                    std::min(max.Y - origin.Y, CHUNK_DIMENSION - 1),
+                    std::min(max.Z - origin.Z, CHUNK_DIMENSION - 1)};
+                m_Edits[ChunkCoords{cx, cy, cz}].push_back(
+                    {block, static_cast<LocalBlockCoords>(localMin),
+                     static_cast<LocalBlockCoords>(localMax)});
+            }
+        }
+    }
+}
+
+size_t World::EditBatch::Commit()
+{
+    size_t chunksWritten = 0;
+
+    for (const auto& [coords, edits] : m_Edits)
+    {
+        Chunk* const chunk = m_World.GetChunk(coords);
+        if (!chunk)
+            continue;
+
+        uint8_t touchedBorders = 0;
+        uint8_t touchedSections = 0;
+        for (const LocalEdit& edit : edits)
+        {
+            chunk->FillBlocks(edit.Block, edit.Min, edit.Max);
+            touchedBorders |= TouchedChunkBorders(edit.Min, edit.Max);
+            touchedSections |=
+                MeshBuilder::SectionsForRows(edit.Min.Y, edit.Max.Y);
+        }
+        // Triggering a rebuild is only setting a flag, so neighbors shared
+        // between edited chunks cost nothing extra
+        TriggerNeighborRebuilds(*chunk, touchedBorders, touchedSections);
+        chunksWritten++;
+    }
+
+    m_Edits.clear();
+    return chunksWritten;
+}
+
 PlayerView World::GetPlayerView() const
 {
     return {&m_ECS.GetComponent<TransformComponent>(m_Player),
@@ -128,23 +337,47 @@ bool World::IsPlayerPhysicsEnabled() const
 
 void World::Update(const Camera& camera)
 {
-    const ChunkCoords playerPositionOld = static_cast<ChunkCoords>(
-        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+    const WorldCoords playerWorldPositionOld =
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position;
     if (m_PlayerControllerEnabled)
         m_PlayerController->Update(camera);
     PhysicsSystem::Update(m_ECS, *this);
-    const ChunkCoords playerPositionNew = static_cast<ChunkCoords>(
-        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+    const WorldCoords playerWorldPositionNew =
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position;
+    m_PlayerVelocity = playerWorldPositionNew - playerWorldPositionOld;
+    m_SmoothedPlayerVelocity +=
+        (m_PlayerVelocity - m_SmoothedPlayerVelocity) * k_VelocitySmoothing;
+
+    const ChunkCoords playerPositionOld =
+        static_cast<ChunkCoords>(playerWorldPositionOld);
+    const ChunkCoords playerPositionNew =
+        static_cast<ChunkCoords>(playerWorldPositionNew);
+    m_ChunkPrioritizer.Update(playerPositionNew, m_PlayerVelocity, &camera);
 
     if (playerPositionOld != playerPositionNew)
     {
         UpdateLoadedChunkQueue();
-        UnloadChunks();
+        UpdateUnloadedChunkQueue();
         SortChunksByPlayerDistance();
         LOG_WARN("Entered new chunk!");
     }
+    const ChunkCoords predictedChunk =
+        PredictChunk(playerWorldPositionNew, m_SmoothedPlayerVelocity);
+    if (playerPositionOld != playerPositionNew ||
+        predictedChunk != m_PredictedChunk)
+    {
+        m_PredictedChunk = predictedChunk;
+        UpdatePrefetchQueue();
+    }
     LoadChunks();
+    UnloadChunks();
     UpdateChunkMeshes();
+    UploadChunkMeshes();
+    m_LodManager.Update(playerPositionNew, m_WorldGenerator,
+                        m_StreamingScheduler);
+    if (Config::EnableHorizon)
+        m_Horizon.Update(playerWorldPositionNew, m_WorldGenerator,
+                         m_StreamingScheduler);
     UpdateChunkRenderList();
 }
 
@@ -155,8 +388,7 @@ void World::UpdateLoadedChunkQueue()
     const ChunkCoords playerChunkPosition =
         static_cast<ChunkCoords>(playerPosition);
 
-    m_ChunkLoadList.clear();
-    m_ChunkLoadIndex = 0;
+    m_ChunkLoadQueue.clear();
 
     constexpr int dist = Config::ChunkLoadDistance;
 
@@ -169,45 +401,134 @@ void World::UpdateLoadedChunkQueue()
                 ChunkCoords coords = playerChunkPosition + ChunkCoords{x, y, z};
                 if (m_LoadedChunks.find(coords) == m_LoadedChunks.end())
                 {
-                    m_ChunkLoadList.push_back(coords);
+                    // Priorities get filled in by LoadChunks()
+                    m_ChunkLoadQueue.push_back({coords, 0.0f});
+                }
+            }
+        }
+    }
+}
+
+void World::UpdateUnloadedChunkQueue()
+{
+    const ChunkCoords playerChunkPosition = static_cast<ChunkCoords>(
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+
+    m_ChunkUnloadList.clear();
+    m_ChunkUnloadIndex = 0;
+
+    for (const auto& [coords, chunk] : m_LoadedChunks)
+    {
+        if (!InLoadDistance(coords, playerChunkPosition) &&
+            !m_PrefetchedChunks.contains(coords))
+        {
+            m_ChunkUnloadList.push_back(coords);
+        }
+    }
+}
+
+void World::UpdatePrefetchQueue()
+{
+    const ChunkCoords playerChunkPosition = static_cast<ChunkCoords>(
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+
+    // Chunks that came into the load distance are regular chunks now, and the
+    // ones the prediction no longer covers were a wrong guess
+    for (auto it = m_PrefetchedChunks.begin(); it != m_PrefetchedChunks.end();)
+    {
+        const ChunkCoords coords = *it;
+        if (InLoadDistance(coords, playerChunkPosition))
+        {
+            it = m_PrefetchedChunks.erase(it);
+        }
+        else if (!InLoadDistance(coords, m_PredictedChunk))
+        {
+            m_ChunkUnloadList.push_back(coords);
+            it = m_PrefetchedChunks.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    m_PrefetchList.clear();
+    m_PrefetchIndex = 0;
+
+    const size_t maxPrefetched = MaxPrefetchedChunks(
+        m_ChunkUnloadList.size() - m_ChunkUnloadIndex);
+    if (m_PrefetchedChunks.size() >= maxPrefetched)
+        return;
+
+    constexpr int dist = Config::ChunkLoadDistance;
+
+    for (int y = -dist; y <= dist; y++)
+    {
+        for (int z = -dist; z <= dist; z++)
+        {
+            for (int x = -dist; x <= dist; x++)
+            {
+                const ChunkCoords coords =
+                    m_PredictedChunk + ChunkCoords{x, y, z};
+                if (!InLoadDistance(coords, playerChunkPosition) &&
+                    !m_LoadedChunks.contains(coords))
+                {
+                    m_PrefetchList.push_back(coords);
                 }
             }
         }
     }
 
-    std::sort(m_ChunkLoadList.begin(), m_ChunkLoadList.end(),
+    std::sort(m_PrefetchList.begin(), m_PrefetchList.end(),
               [playerChunkPosition](ChunkCoords c1, ChunkCoords c2) {
-                  ChunkCoords diff1 = c1 - playerChunkPosition;
-                  ChunkCoords diff2 = c2 - playerChunkPosition;
+                  const ChunkCoords diff1 = c1 - playerChunkPosition;
+                  const ChunkCoords diff2 = c2 - playerChunkPosition;
                   return diff1.NormSq() < diff2.NormSq();
               });
+    m_PrefetchList.resize(std::min(m_PrefetchList.size(),
+                                   maxPrefetched - m_PrefetchedChunks.size()));
 }
 
 void World::UnloadChunks()
 {
-    const WorldCoords playerPosition =
-        m_ECS.GetComponent<TransformComponent>(m_Player).Position;
-    const ChunkCoords playerChunkPosition =
-        static_cast<ChunkCoords>(playerPosition);
+    const ChunkCoords playerChunkPosition = static_cast<ChunkCoords>(
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+
+    std::vector<Chunk*> unloaded{};
 
-    for (auto it = m_LoadedChunks.begin(); it != m_LoadedChunks.end();)
+    m_StreamingScheduler.BeginStage(StreamingStage::Unload);
+    while (m_ChunkUnloadIndex < m_ChunkUnloadList.size() &&
+           m_StreamingScheduler.NextUnit())
     {
-        const ChunkCoords chunkPos = it->first;
+        const ChunkCoords coords = m_ChunkUnloadList[m_ChunkUnloadIndex++];
+        // The player might have turned back since the chunk was queued
+        if (InLoadDistance(coords, playerChunkPosition) ||
+            m_PrefetchedChunks.contains(coords))
+            continue;
 
-        const ChunkCoords diff = chunkPos - playerChunkPosition;
-        if (std::abs(diff.X) > Config::ChunkLoadDistance ||
-            std::abs(diff.Y) > Config::ChunkLoadDistance ||
-            std::abs(diff.Z) > Config::ChunkLoadDistance)
+        if (auto it = m_LoadedChunks.find(coords); it != m_LoadedChunks.end())
         {
-            Chunk* chunk = it->second;
-            delete chunk;
-            it = m_LoadedChunks.erase(it);
-        }
-        else
-        {
-            it++;
+            unloaded.push_back(it->second);
+            m_LoadedChunks.erase(it);
+            g_DebugState.Unloaded++;
         }
     }
+    m_StreamingScheduler.EndStage();
+
+    if (unloaded.empty())
+        return;
+
+    std::sort(unloaded.begin(), unloaded.end());
+    const auto wasUnloaded = [&unloaded](const Chunk* chunk) {
+        return std::binary_search(unloaded.begin(), unloaded.end(), chunk);
+    };
+    std::erase_if(m_ChunksByDistance, wasUnloaded);
+    std::erase_if(m_PendingUploads, wasUnloaded);
+
+    for (Chunk* chunk : unloaded)
+    {
+        delete chunk;
+    }
 }
 
 void World::SortChunksByPlayerDistance()
@@ -220,29 +541,86 @@ void World::SortChunksByPlayerDistance()
         m_ChunksByDistance.push_back(chunk);
     }
     std::sort(m_ChunksByDistance.begin(), m_ChunksByDistance.end(),
-              [playerChunkPosition](const Chunk* c1, const Chunk* c2) {
-                  const ChunkCoords diff1 =
-                      c1->GetCoords() - playerChunkPosition;
-                  const ChunkCoords diff2 =
-                      c2->GetCoords() - playerChunkPosition;
-                  return diff1.NormSq() < diff2.NormSq();
-              });
+              CloserToChunk{playerChunkPosition});
+}
+
+void World::InsertChunkByDistance(Chunk* chunk)
+{
+    // Keeps the list sorted, the render list relies on it to stop at the
+    // render distance
+    const ChunkCoords playerChunkPosition = static_cast<ChunkCoords>(
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+    const auto it =
+        std::upper_bound(m_ChunksByDistance.begin(), m_ChunksByDistance.end(),
+                         chunk, CloserToChunk{playerChunkPosition});
+    m_ChunksByDistance.insert(it, chunk);
 }
 
 void World::UpdateChunkMeshes()
 {
-    int updated = 0;
+    const ChunkCoords playerChunkPosition = static_cast<ChunkCoords>(
+        m_ECS.GetComponent<TransformComponent>(m_Player).Position);
+
+    m_RemeshQueue.clear();
     for (Chunk* chunk : m_ChunksByDistance)
     {
-        if (chunk->NeedsRebuild())
+        // Prefetched chunks get meshed once they come into the load distance
+        if (!chunk->NeedsRebuild() ||
+            !InLoadDistance(chunk->GetCoords(), playerChunkPosition))
+            continue;
+
+        // Neighbor loads and edits request rebuilds without knowing whether
+        // anything the mesh depends on changed, e.g. air next to air
+        if (!chunk->MeshInputsChanged())
         {
-            g_DebugState.Remeshes++;
-            updated++;
-            chunk->RebuildMesh(*this);
+            chunk->DiscardRebuild();
+            g_DebugState.RemeshesSkipped++;
+            continue;
         }
-        if (updated > 8)
-            break;
+
+        m_RemeshQueue.push_back(
+            {chunk, m_ChunkPrioritizer.GetPriority(chunk->GetCoords())});
     }
+    std::make_heap(m_RemeshQueue.begin(), m_RemeshQueue.end());
+
+    m_StreamingScheduler.BeginStage(StreamingStage::Mesh);
+    while (!m_RemeshQueue.empty() && m_StreamingScheduler.NextUnit())
+    {
+        std::pop_heap(m_RemeshQueue.begin(), m_RemeshQueue.end());
+        Chunk* const chunk = m_RemeshQueue.back().Value;
+        m_RemeshQueue.pop_back();
+
+        g_DebugState.Remeshes++;
+        g_DebugState.RemeshedSections +=
+            std::popcount(chunk->GetDirtySections());
+        if (!chunk->NeedsUpload())
+            m_PendingUploads.push_back(chunk);
+        // Without all neighbors the key would change as soon as they load
+        MeshCache* const cache =
+            chunk->HasAllNeighbors() ? m_MeshCache.get() : nullptr;
+        if (chunk->BuildMesh(cache))
+            g_DebugState.CachedMeshes++;
+    }
+    // The LOD rings get what is left of the budget
+    m_LodManager.BuildMeshes(m_MeshCache.get(), m_StreamingScheduler);
+    m_StreamingScheduler.EndStage();
+}
+
+void World::UploadChunkMeshes()
+{
+    size_t uploaded = 0;
+
+    m_StreamingScheduler.BeginStage(StreamingStage::Upload);
+    while (uploaded < m_PendingUploads.size() &&
+           m_StreamingScheduler.NextUnit())
+    {
+        m_PendingUploads[uploaded++]->UploadMesh();
+        g_DebugState.Uploads++;
+    }
+    m_StreamingScheduler.EndStage();
+
+    m_PendingUploads.erase(m_PendingUploads.begin(),
+                           m_PendingUploads.begin() + uploaded);
 }
 
 void World::UpdateChunkRenderList()
@@ -259,6 +637,8 @@ void World::UpdateChunkRenderList()
             std::abs(diff.Y) > Config::ChunkRenderDistance ||
             std::abs(diff.Z) > Config::ChunkRenderDistance)
             break;
+        if (!m_LodManager.DrawsRegularChunk(chunk->GetCoords()))
+            continue;
         const ChunkMesh& mesh = chunk->GetMesh();
         if (mesh.NumOpaqueVertices() > 0)
         {
@@ -269,32 +649,114 @@ void World::UpdateChunkRenderList()
             m_WaterRenderList.push_back(chunk);
         }
     }
+
+    // Every LOD chunk is farther than the regular ones, which keeps both lists
+    // sorted by distance
+    const std::vector<const Chunk*>& lodChunks = m_LodManager.GetRenderList();
+    m_ChunkRenderList.insert(m_ChunkRenderList.end(), lodChunks.begin(),
+                             lodChunks.end());
+    const std::vector<const Chunk*>& lodWater =
+        m_LodManager.GetWaterRenderList();
+    m_WaterRenderList.insert(m_WaterRenderList.end(), lodWater.begin(),
+                             lodWater.end());
+
+    // Every new revision has the culler rebuild its clusters
+    const bool chunksChanged =
+        UpdateRenderListKeys(m_ChunkRenderList, m_ChunkRenderKeys);
+    const bool waterChanged =
+        UpdateRenderListKeys(m_WaterRenderList, m_WaterRenderKeys);
+    if (chunksChanged || waterChanged)
+        m_RenderListRevision++;
+}
+
+// Returns whether the list differs from the keys, which then get updated. A
+// freed chunk's memory can come back as another chunk, so the pointers alone
+// aren't enough
+bool World::UpdateRenderListKeys(const std::vector<const Chunk*>& list,
+                                 std::vector<RenderListKey>& keys)
+{
+    bool changed = list.size() != keys.size();
+    keys.resize(list.size());
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        const RenderListKey key{list[i], list[i]->GetCoords(),
+                                list[i]->GetLodLevel()};
+        if (key != keys[i])
+        {
+            keys[i] = key;
+            changed = true;
+        }
+    }
+    return changed;
 }
 
 void World::LoadChunks()
 {
-    static constexpr int maxChunksLoaded = 64;
-    for (int i = 0;
-         i < maxChunksLoaded && m_ChunkLoadIndex < m_ChunkLoadList.size(); i++)
+    // Recomputing every priority and rebuilding the heap is linear, so the
+    // queue can follow the camera every tick without a full sort
+    for (Prioritized<ChunkCoords>& entry : m_ChunkLoadQueue)
+    {
+        entry.Priority = m_ChunkPrioritizer.GetPriority(entry.Value);
+    }
+    std::make_heap(m_ChunkLoadQueue.begin(), m_ChunkLoadQueue.end());
+
+    m_StreamingScheduler.BeginStage(StreamingStage::Generate);
+    while (!m_ChunkLoadQueue.empty() && m_StreamingScheduler.NextUnit())
+    {
+        std::pop_heap(m_ChunkLoadQueue.begin(), m_ChunkLoadQueue.end());
+        LoadChunk(m_ChunkLoadQueue.back().Value);
+        m_ChunkLoadQueue.pop_back();
+    }
+    // Prefetching only gets whatever budget the regular queue leaves over
+    while (m_ChunkLoadQueue.empty() &&
+           m_PrefetchIndex < m_PrefetchList.size() &&
+           m_StreamingScheduler.NextUnit())
     {
-        g_DebugState.Loaded++;
-        const ChunkCoords coords = m_ChunkLoadList[m_ChunkLoadIndex++];
+        // Unloads queued since the list was made still hold their slots
+        if (m_PrefetchedChunks.size() >=
+            MaxPrefetchedChunks(m_ChunkUnloadList.size() - m_ChunkUnloadIndex))
+            break;
+        const ChunkCoords coords = m_PrefetchList[m_PrefetchIndex++];
+        if (m_LoadedChunks.contains(coords))
+            continue;
 
-        for (BlockCoords faceNormal : ChunkUtils::k_FaceNormals)
+        LoadChunk(coords);
+        m_PrefetchedChunks.insert(coords);
+        g_DebugState.Prefetched++;
+    }
+    m_StreamingScheduler.EndStage();
+}
+
+void World::LoadChunk(ChunkCoords coords)
+{
+    g_DebugState.Loaded++;
+
+    Chunk* const newChunk = new Chunk{coords};
+
+    // The only hash lookups for neighbors, everything else follows the links
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
         {
-            const ChunkCoords neighbor{coords.X + faceNormal.X,
-                                       coords.Y + faceNormal.Y,
-                                       coords.Z + faceNormal.Z};
-            if (auto it = m_LoadedChunks.find(neighbor);
-                it != m_LoadedChunks.end())
+            for (int dx = -1; dx <= 1; dx++)
             {
-                Chunk* neighbor = it->second;
-                neighbor->TriggerRebuild();
+                if (dx == 0 && dy == 0 && dz == 0)
+                    continue;
+                const ChunkCoords neighborCoords =
+                    coords + ChunkCoords{dx, dy, dz};
+                if (auto it = m_LoadedChunks.find(neighborCoords);
+                    it != m_LoadedChunks.end())
+                {
+                    newChunk->LinkNeighbor(
+                        it->second, ChunkUtils::NeighborIndex(dx, dy, dz));
+                }
             }
         }
-
-        Chunk* const newChunk = m_WorldGenerator.GenerateChunk(coords);
-        m_ChunksByDistance.push_back(newChunk);
-        m_LoadedChunks[coords] = newChunk;
     }
+
+    m_WorldGenerator.GenerateChunk(*newChunk);
+    TriggerNeighborRebuilds(*newChunk, k_AllFaces, MeshBuilder::ALL_SECTIONS);
+
+    InsertChunkByDistance(newChunk);
+    m_LoadedChunks[coords] = newChunk;
 }
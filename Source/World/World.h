@@ -3,11 +3,17 @@
 #include "../ECS/ECS.h"
 #include "../Memory/ChunkAllocator.h"
 #include "Chunk.h"
+#include "ChunkPrioritizer.h"
+#include "Horizon.h"
+#include "LodManager.h"
+#include "MeshCache.h"
 #include "PlayerController.h"
+#include "StreamingScheduler.h"
 #include "WorldGenerator.h"
 #include <glm/glm.hpp>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class Camera;
@@ -26,6 +32,36 @@ struct PlayerView
 class World
 {
   public:
+    // Collects block edits and applies them on Commit(), grouped by chunk so
+    // that every chunk is written in bulk, and each affected chunk, including
+    // the neighbors sharing an edited border, is invalidated only once
+    class EditBatch
+    {
+      public:
+        explicit EditBatch(World& world) : m_World{world} {}
+
+        void SetBlock(BlockType block, BlockCoords blockCoords);
+
+        // Fills the box between two opposite corners, both inclusive
+        void Fill(BlockType block, BlockCoords min, BlockCoords max);
+
+        // Applies the edits in the order they were made. Like PlaceBlock(),
+        // edits to chunks that aren't loaded are dropped. Returns the number of
+        // chunks written to
+        size_t Commit();
+
+      private:
+        struct LocalEdit
+        {
+            BlockType Block;
+            LocalBlockCoords Min;
+            LocalBlockCoords Max;
+        };
+
+        World& m_World;
+        std::unordered_map<ChunkCoords, std::vector<LocalEdit>> m_Edits{};
+    };
+
     World() = default;
 
     void Init();
@@ -34,10 +70,13 @@ class World
 
     BlockType GetBlock(BlockCoords blockCoords) const;
     Chunk* GetChunk(ChunkCoords chunkCoords);
+    const Chunk* GetChunk(ChunkCoords chunkCoords) const;
 
     bool PlaceBlock(BlockType block, BlockCoords blockCoords);
     bool BreakBlock(BlockCoords blockCoords);
 
+    EditBatch BeginEdit() { return EditBatch{*this}; }
+
     PlayerView GetPlayerView() const;
 
     void SetPlayerActiveBlock(BlockType block);
@@ -63,19 +102,42 @@ class World
         return m_WaterRenderList;
     }
 
+    // Changes whenever chunks get added to or removed from the render lists,
+    // or change places in them
+    uint32_t GetRenderListRevision() const { return m_RenderListRevision; }
+
+    const Horizon& GetHorizon() const { return m_Horizon; }
+
     WorldCoords GetLightDir() const { return m_LightDir; }
 
     friend class UIOverlay;
 
   private:
+    // What the culler's clusters are built from, for each render list entry
+    struct RenderListKey
+    {
+        const Chunk* Pointer;
+        ChunkCoords Coords;
+        uint8_t LodLevel;
+
+        bool operator==(const RenderListKey&) const = default;
+    };
+
     void RegisterComponents();
 
     void UpdateLoadedChunkQueue();
+    void UpdateUnloadedChunkQueue();
+    void UpdatePrefetchQueue();
     void LoadChunks();
+    void LoadChunk(ChunkCoords coords);
     void UnloadChunks();
     void SortChunksByPlayerDistance();
+    void InsertChunkByDistance(Chunk* chunk);
     void UpdateChunkMeshes();
+    void UploadChunkMeshes();
     void UpdateChunkRenderList();
+    static bool UpdateRenderListKeys(const std::vector<const Chunk*>& list,
+                                     std::vector<RenderListKey>& keys);
 
   private:
     ChunkMap m_LoadedChunks{};
@@ -83,13 +145,36 @@ class World
     Entity m_Player{};
 
     std::unique_ptr<PlayerController> m_PlayerController{};
-    std::vector<ChunkCoords> m_ChunkLoadList{};
-    size_t m_ChunkLoadIndex = 0;
+    // Both queues are binary heaps, reprioritized every tick
+    std::vector<Prioritized<ChunkCoords>> m_ChunkLoadQueue{};
+    std::vector<Prioritized<Chunk*>> m_RemeshQueue{};
+    // Generated only once the load queue is empty, nearest first
+    std::vector<ChunkCoords> m_PrefetchList{};
+    size_t m_PrefetchIndex = 0;
+    // Chunks outside the load distance kept alive by the prediction
+    std::unordered_set<ChunkCoords> m_PrefetchedChunks{};
+    ChunkCoords m_PredictedChunk{};
+    std::vector<ChunkCoords> m_ChunkUnloadList{};
+    size_t m_ChunkUnloadIndex = 0;
     std::vector<Chunk*> m_ChunksByDistance{};
+    std::vector<Chunk*> m_PendingUploads{};
     std::vector<const Chunk*> m_ChunkRenderList{};
     std::vector<const Chunk*> m_WaterRenderList{};
-    WorldGenerator m_WorldGenerator{this};
+    // The lists as of their current revision
+    std::vector<RenderListKey> m_ChunkRenderKeys{};
+    std::vector<RenderListKey> m_WaterRenderKeys{};
+    uint32_t m_RenderListRevision = 0;
+    StreamingScheduler m_StreamingScheduler{};
+    ChunkPrioritizer m_ChunkPrioritizer{};
+    WorldGenerator m_WorldGenerator{};
+    std::unique_ptr<MeshCache> m_MeshCache{};
+    LodManager m_LodManager{};
+    Horizon m_Horizon{};
     WorldCoords m_LightDir{0.6f, -0.7f, 0.2f};
+    // In blocks per tick, measured from the player's position so that it also
+    // works without physics
+    WorldCoords m_PlayerVelocity{};
+    WorldCoords m_SmoothedPlayerVelocity{};
 
     bool m_PlayerControllerEnabled = true;
 };
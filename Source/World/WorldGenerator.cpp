@@ -2,7 +2,7 @@
 #include "ChunkUtils.h"
 #include "Core/Logger.h"
 #include "Math/Noise.h"
-#include "World.h"
+#include <algorithm>
 #include <cassert>
 #include <span>
 
@@ -86,8 +86,8 @@ static int BlockHeightFromFloat(float floatHeight)
     return static_cast<int>(std::roundf(blockHeightF));
 }
 
-WorldGenerator::WorldGenerator(World* world)
-    : m_World{world}, m_HeightOctaveNoise{HeightMapConfig.OctaveConfig},
+WorldGenerator::WorldGenerator()
+    : m_HeightOctaveNoise{HeightMapConfig.OctaveConfig},
       m_MoistureOctaveNoise{MoistureMapConfig.OctaveConfig}
 {
 }
@@ -200,9 +200,6 @@ void WorldGenerator::BuildTerrainFeature(Chunk& chunk,
     std::span<RelativeBlockPlacement> blocks = GetFeatureBlocks(feature);
 
     const ChunkCoords chunkCoords = chunk.GetCoords();
-    const BlockCoords chunkBlockCoordsStart = {chunkCoords.X * CHUNK_DIMENSION,
-                                               chunkCoords.Y * CHUNK_DIMENSION,
-                                               chunkCoords.Z * CHUNK_DIMENSION};
 
     for (RelativeBlockPlacement block : blocks)
     {
@@ -215,15 +212,16 @@ void WorldGenerator::BuildTerrainFeature(Chunk& chunk,
         }
         else
         {
-            const ChunkCoords neighborChunkCoords =
-                static_cast<ChunkCoords>(chunkBlockCoordsStart + blockCoords);
-            if (Chunk* neighborChunk = m_World->GetChunk(neighborChunkCoords))
+            // Features are small enough to only spill into adjacent chunks
+            const ChunkCoords offset = static_cast<ChunkCoords>(blockCoords);
+            if (Chunk* neighborChunk =
+                    chunk.GetNeighbor(offset.X, offset.Y, offset.Z))
             {
                 neighborChunk->SetBlock(block.Block, localCoords.ToIndex());
             }
             else
             {
-                m_ToPlace[neighborChunkCoords].push_back(
+                m_ToPlace[chunkCoords + offset].push_back(
                     LocalBlockPlacement{block.Block, localCoords.ToIndex()});
             }
         }
@@ -325,12 +323,12 @@ static BlockType GetGroundBlock(Biome biome, int depth)
 BlockType WorldGenerator::GetBlock(int surfaceHeight, int blockHeight,
                                    Biome biome) const
 {
-    if (blockHeight < -20)
+    if (blockHeight < MIN_HEIGHT)
         return BlockType::Air;
 
     if (blockHeight > surfaceHeight)
     {
-        if (biome == Biome::Ocean && blockHeight < 30)
+        if (biome == Biome::Ocean && blockHeight < SEA_LEVEL)
             return BlockType::Water;
         else
             return BlockType::Air;
@@ -358,6 +356,33 @@ BlockType WorldGenerator::GetBlock(int surfaceHeight, int blockHeight,
     }*/
 }
 
+BlockType WorldGenerator::GetLodBlock(int surfaceHeight, int bottomHeight,
+                                      int size, Biome biome) const
+{
+    // Solid blocks run from the bottom of the world up to the surface, water
+    // from there up to sea level, so both can be counted without visiting
+    // every block
+    const int topHeight = bottomHeight + size - 1;
+    const int solidTop = std::min(topHeight, surfaceHeight);
+    const int solidBottom = std::max(bottomHeight, MIN_HEIGHT);
+    const int numSolid = std::max(0, solidTop - solidBottom + 1);
+
+    int numWater = 0;
+    if (biome == Biome::Ocean)
+    {
+        const int waterTop = std::min(topHeight, SEA_LEVEL - 1);
+        const int waterBottom = std::max(
+            std::max(bottomHeight, surfaceHeight + 1), MIN_HEIGHT);
+        numWater = std::max(0, waterTop - waterBottom + 1);
+    }
+
+    if (2 * numSolid >= size)
+        return GetBlock(surfaceHeight, solidTop, biome);
+    if (2 * (numSolid + numWater) >= size)
+        return BlockType::Water;
+    return BlockType::Air;
+}
+
 void WorldGenerator::BuildTerrain(Chunk& chunk,
                                   const ChunkGenInfo& genInfo) const
 {
@@ -383,16 +408,54 @@ void WorldGenerator::BuildTerrain(Chunk& chunk,
     }
 }
 
-Chunk* WorldGenerator::GenerateChunk(ChunkCoords chunkCoords)
+void WorldGenerator::GenerateChunk(Chunk& chunk)
 {
     const ChunkGenInfo& genInfo =
-        GetChunkGenInfo(static_cast<ChunkCoords2D>(chunkCoords));
+        GetChunkGenInfo(static_cast<ChunkCoords2D>(chunk.GetCoords()));
 
-    Chunk* const chunk = new Chunk{chunkCoords};
+    BuildTerrain(chunk, genInfo);
 
-    BuildTerrain(*chunk, genInfo);
+    BuildTerrainFeatures(chunk, genInfo);
+}
+
+SurfaceSample WorldGenerator::SampleSurface(int blockX, int blockZ) const
+{
+    const float height = GenerateHeight(blockX, blockZ);
+    const float moisture = GenerateMoisture(blockX, blockZ);
+
+    const int surfaceHeight = BlockHeightFromFloat(height);
+    const Biome biome = GetBiome(height, moisture);
+    if (biome == Biome::Ocean && surfaceHeight < SEA_LEVEL - 1)
+        return {SEA_LEVEL, BlockType::Water};
+    return {surfaceHeight + 1, GetSurfaceBlock(biome)};
+}
 
-    BuildTerrainFeatures(*chunk, genInfo);
+void WorldGenerator::GenerateLodChunk(Chunk& chunk) const
+{
+    const int scale = chunk.GetScale();
+    const BlockCoords origin = chunk.GetOrigin();
+    for (uint8_t z = 0; z < CHUNK_DIMENSION; z++)
+    {
+        for (uint8_t x = 0; x < CHUNK_DIMENSION; x++)
+        {
+            // One sample from the middle of the columns the block covers
+            const int blockX = origin.X + x * scale + scale / 2;
+            const int blockZ = origin.Z + z * scale + scale / 2;
+            const float height = GenerateHeight(blockX, blockZ);
+            const float moisture = GenerateMoisture(blockX, blockZ);
 
-    return chunk;
+            const int surfaceHeight = BlockHeightFromFloat(height);
+            const Biome biome = GetBiome(height, moisture);
+            for (uint8_t y = 0; y < CHUNK_DIMENSION; y++)
+            {
+                const int bottomHeight = origin.Y + y * scale;
+                // Everything above is air, which the chunk starts out as
+                if (bottomHeight > surfaceHeight && bottomHeight >= SEA_LEVEL)
+                    break;
+                const BlockType block =
+                    GetLodBlock(surfaceHeight, bottomHeight, scale, biome);
+                chunk.SetBlock(block, x, y, z);
+            }
+        }
+    }
 }
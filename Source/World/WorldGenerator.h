@@ -48,15 +48,39 @@ struct LocalBlockPlacement
     size_t Index;
 };
 
-class World;
+struct SurfaceSample
+{
+    // Height of the top face of the column's highest block, water included
+    int Height;
+    // The block seen from above
+    BlockType Block;
+};
 
 class WorldGenerator
 {
   public:
+    // Everything generated, features included, lies between these heights
+    static constexpr int MIN_HEIGHT = -20;
+    static constexpr int MAX_HEIGHT = 140;
+    // Oceans are filled with water up to, but not including, this height
+    static constexpr int SEA_LEVEL = 30;
+
     // Change this to use seed
-    explicit WorldGenerator(World* world);
+    WorldGenerator();
 
-    Chunk* GenerateChunk(ChunkCoords coords);
+    // Fills in the blocks of a newly created chunk. The chunk should already
+    // be linked to its loaded neighbors, features that cross the chunk border
+    // get placed into them through the neighbor pointers
+    void GenerateChunk(Chunk& chunk);
+
+    // Fills in a chunk of a LOD level above zero straight from the height
+    // and moisture noise, without features. Each block takes the majority of
+    // the blocks it covers, solid ones keeping the topmost block's type
+    void GenerateLodChunk(Chunk& chunk) const;
+
+    // The top of the generated column at the block, without features, for
+    // terrain too far away to have chunks at all
+    SurfaceSample SampleSurface(int blockX, int blockZ) const;
 
   private:
     ChunkHeightMap GenerateHeightMap(ChunkCoords2D coords) const;
@@ -84,8 +108,12 @@ class WorldGenerator
 
     BlockType GetBlock(int surfaceHeight, int blockHeight, Biome biome) const;
 
+    // The block standing in for the size blocks of a column starting at
+    // bottomHeight
+    BlockType GetLodBlock(int surfaceHeight, int bottomHeight, int size,
+                          Biome biome) const;
+
   private:
-    World* m_World;
     LRUCache<ChunkCoords2D, ChunkGenInfo> m_Cache{256};
     std::unordered_map<ChunkCoords, std::vector<LocalBlockPlacement>>
         m_ToPlace{};